@@ -0,0 +1,252 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdalign.h>
+
+#include "bench.h"
+#include "commands.h"
+#include "human.h"
+#include "layout.h"
+
+// Hash aggregation: SELECT key, count(*), sum(height), min(height),
+// max(height) FROM humans GROUP BY key, with the per-group aggregate state
+// stored in different layouts. Keys are either `age` (100 groups, the table
+// stays in L1) or a composite of age, name and height with a few hundred
+// thousand groups, where the state size decides how much of the table fits
+// in cache.
+
+#define EMPTY_KEY UINT32_MAX
+
+// Declaration order as one would naturally write it: 8 bytes of padding.
+typedef struct AggPadded {
+    uint32_t key;
+    double   sum;
+    uint32_t count;
+    double   min;
+    double   max;
+} agg_padded_t;
+
+// Same members sorted by alignment: no padding.
+typedef struct AggSorted {
+    double   sum;
+    double   min;
+    double   max;
+    uint32_t key;
+    uint32_t count;
+} agg_sorted_t;
+
+// Padded order with packing forced: as small as the sorted order, but the
+// doubles are misaligned.
+typedef struct __attribute__((packed)) AggPacked {
+    uint32_t key;
+    double   sum;
+    uint32_t count;
+    double   min;
+    double   max;
+} agg_packed_t;
+
+// One array per aggregate.
+typedef struct AggSplit {
+    uint32_t *key;
+    uint32_t *count;
+    double   *sum;
+    double   *min;
+    double   *max;
+} agg_split_t;
+
+struct AggResult {
+    size_t groups;
+    uint64_t count;
+    double sum;
+    size_t table_bytes;
+};
+
+static inline uint32_t hash_key(uint32_t key, size_t mask) {
+    return (uint32_t)(((uint64_t)key * 0x9e3779b97f4a7c15u) >> 32) & (uint32_t)mask;
+}
+
+static inline uint32_t age_key(const human1_t *h) {
+    return (uint32_t)h->age;
+}
+
+// Mixes age, the second letter of each name and height in centimetres.
+static inline uint32_t composite_key(const human1_t *h) {
+    uint32_t cm = (uint32_t)(h->height * 100.0 + 0.5);
+    return (uint32_t)h->age << 24 ^ (uint32_t)(unsigned char)h->name.first[1] << 16 ^
+           (uint32_t)(unsigned char)h->name.last[1] << 8 ^ cm;
+}
+
+// Generates an insert-or-update aggregation over a table of AoS states.
+#define AGG_AOS(T, fname)                                                                   \
+    static struct AggResult fname(const human1_t *rows, size_t nrows, size_t passes,          \
+                                  size_t capacity, int composite) {                          \
+        T *table = malloc(capacity * sizeof *table);                                          \
+        struct AggResult res = {0, 0, 0.0, capacity * sizeof *table};                         \
+        size_t mask = capacity - 1;                                                           \
+        if (!table) return res;                                                               \
+        for (size_t i = 0; i < capacity; i++) table[i].key = EMPTY_KEY;                       \
+        for (size_t p = 0; p < passes; p++) {                                                 \
+            for (size_t r = 0; r < nrows; r++) {                                              \
+                uint32_t key = composite ? composite_key(&rows[r]) : age_key(&rows[r]);       \
+                double h = rows[r].height;                                                    \
+                size_t slot = hash_key(key, mask);                                            \
+                while (table[slot].key != key && table[slot].key != EMPTY_KEY) {              \
+                    slot = (slot + 1) & mask;                                                 \
+                }                                                                             \
+                if (table[slot].key == EMPTY_KEY) {                                           \
+                    table[slot].key = key;                                                    \
+                    table[slot].count = 0;                                                    \
+                    table[slot].sum = 0.0;                                                    \
+                    table[slot].min = h;                                                      \
+                    table[slot].max = h;                                                      \
+                }                                                                             \
+                table[slot].count++;                                                          \
+                table[slot].sum += h;                                                         \
+                if (h < table[slot].min) table[slot].min = h;                                 \
+                if (h > table[slot].max) table[slot].max = h;                                 \
+            }                                                                                 \
+        }                                                                                     \
+        for (size_t i = 0; i < capacity; i++) {                                               \
+            if (table[i].key == EMPTY_KEY) continue;                                          \
+            res.groups++;                                                                     \
+            res.count += table[i].count;                                                      \
+            res.sum += table[i].sum + table[i].min - table[i].max;                            \
+        }                                                                                     \
+        free(table);                                                                          \
+        return res;                                                                           \
+    }
+
+AGG_AOS(agg_padded_t, aggregate_padded)
+AGG_AOS(agg_sorted_t, aggregate_sorted)
+AGG_AOS(agg_packed_t, aggregate_packed)
+
+static struct AggResult aggregate_split(const human1_t *rows, size_t nrows, size_t passes,
+                                        size_t capacity, int composite) {
+    agg_split_t t;
+    struct AggResult res = {0, 0, 0.0, capacity * (2 * sizeof(uint32_t) + 3 * sizeof(double))};
+    size_t mask = capacity - 1;
+
+    t.key = malloc(capacity * sizeof *t.key);
+    t.count = malloc(capacity * sizeof *t.count);
+    t.sum = malloc(capacity * sizeof *t.sum);
+    t.min = malloc(capacity * sizeof *t.min);
+    t.max = malloc(capacity * sizeof *t.max);
+    if (t.key && t.count && t.sum && t.min && t.max) {
+        for (size_t i = 0; i < capacity; i++) t.key[i] = EMPTY_KEY;
+        for (size_t p = 0; p < passes; p++) {
+            for (size_t r = 0; r < nrows; r++) {
+                uint32_t key = composite ? composite_key(&rows[r]) : age_key(&rows[r]);
+                double h = rows[r].height;
+                size_t slot = hash_key(key, mask);
+                while (t.key[slot] != key && t.key[slot] != EMPTY_KEY) slot = (slot + 1) & mask;
+                if (t.key[slot] == EMPTY_KEY) {
+                    t.key[slot] = key;
+                    t.count[slot] = 0;
+                    t.sum[slot] = 0.0;
+                    t.min[slot] = h;
+                    t.max[slot] = h;
+                }
+                t.count[slot]++;
+                t.sum[slot] += h;
+                if (h < t.min[slot]) t.min[slot] = h;
+                if (h > t.max[slot]) t.max[slot] = h;
+            }
+        }
+        for (size_t i = 0; i < capacity; i++) {
+            if (t.key[i] == EMPTY_KEY) continue;
+            res.groups++;
+            res.count += t.count[i];
+            res.sum += t.sum[i] + t.min[i] - t.max[i];
+        }
+    }
+    free(t.key);
+    free(t.count);
+    free(t.sum);
+    free(t.min);
+    free(t.max);
+    return res;
+}
+
+static void show_agg_states(void) {
+    struct FieldDesc padded_fields[] = {
+        FIELD(agg_padded_t, key,   'K'),
+        FIELD(agg_padded_t, sum,   'S'),
+        FIELD(agg_padded_t, count, 'C'),
+        FIELD(agg_padded_t, min,   'm'),
+        FIELD(agg_padded_t, max,   'M'),
+    };
+    struct FieldDesc sorted_fields[] = {
+        FIELD(agg_sorted_t, sum,   'S'),
+        FIELD(agg_sorted_t, min,   'm'),
+        FIELD(agg_sorted_t, max,   'M'),
+        FIELD(agg_sorted_t, key,   'K'),
+        FIELD(agg_sorted_t, count, 'C'),
+    };
+    struct FieldDesc packed_fields[] = {
+        FIELD(agg_packed_t, key,   'K'),
+        FIELD(agg_packed_t, sum,   'S'),
+        FIELD(agg_packed_t, count, 'C'),
+        FIELD(agg_packed_t, min,   'm'),
+        FIELD(agg_packed_t, max,   'M'),
+    };
+
+    visualize("AggPadded", sizeof(agg_padded_t), padded_fields, NFIELDS(padded_fields));
+    visualize("AggSorted", sizeof(agg_sorted_t), sorted_fields, NFIELDS(sorted_fields));
+    visualize("AggPacked", sizeof(agg_packed_t), packed_fields, NFIELDS(packed_fields));
+    printf("\nAggSplit: 5 arrays, %zu bytes per group across key/count/sum/min/max\n",
+           2 * sizeof(uint32_t) + 3 * sizeof(double));
+}
+
+int bench_agg(int argc, char **argv) {
+    size_t total = arg_count(argc, argv, 1, 100000000);
+    size_t chunk = total < 4000000 ? total : 4000000;
+    size_t passes = total / chunk;
+    human1_t *rows = malloc(chunk * sizeof *rows);
+    static const struct {
+        const char *label;
+        size_t state_size;
+        struct AggResult (*run)(const human1_t *, size_t, size_t, size_t, int);
+    } variants[] = {
+        {"padded", sizeof(agg_padded_t), aggregate_padded},
+        {"sorted", sizeof(agg_sorted_t), aggregate_sorted},
+        {"packed", sizeof(agg_packed_t), aggregate_packed},
+        {"split", 2 * sizeof(uint32_t) + 3 * sizeof(double), aggregate_split},
+    };
+
+    if (!rows) {
+        fprintf(stderr, "bench-agg: cannot allocate %zu records\n", chunk);
+        return 1;
+    }
+    human_fill(rows, chunk, 7);
+    show_agg_states();
+
+    // The record chunk is re-scanned `passes` times, so large totals need no
+    // more memory than one chunk.
+    for (int composite = 0; composite <= 1; composite++) {
+        // Power of two with a load factor of roughly a third.
+        size_t capacity = composite ? (size_t)1 << 20 : 256;
+        printf("\nGROUP BY %s over %zu records (%zu x %zu):\n",
+               composite ? "age,name,height" : "age", chunk * passes, passes, chunk);
+        printf("%-8s %6s %8s %10s %10s %10s\n", "state", "bytes", "groups", "table KiB", "ms",
+               "Mrows/s");
+        for (size_t v = 0; v < sizeof variants / sizeof variants[0]; v++) {
+            uint64_t t0 = now_ns();
+            struct AggResult res = variants[v].run(rows, chunk, passes, capacity, composite);
+            uint64_t t1 = now_ns();
+            if (res.count != chunk * passes) {
+                fprintf(stderr, "bench-agg: %s lost rows\n", variants[v].label);
+                free(rows);
+                return 1;
+            }
+            bench_sink += (uint64_t)res.sum;
+            printf("%-8s %6zu %8zu %10zu %10.1f %10.1f\n", variants[v].label,
+                   variants[v].state_size, res.groups,
+                   res.table_bytes / 1024, (double)(t1 - t0) / 1e6,
+                   (double)(chunk * passes) / ((double)(t1 - t0) / 1e9) / 1e6);
+        }
+    }
+
+    free(rows);
+    return 0;
+}
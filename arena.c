@@ -0,0 +1,52 @@
+#include <stdalign.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+struct ArenaBlock {
+    struct ArenaBlock *next;
+    alignas(max_align_t) char data[];
+};
+
+void arena_init(arena_t *a, size_t block_size) {
+    a->head = NULL;
+    a->cur = NULL;
+    a->end = NULL;
+    a->block_size = block_size;
+}
+
+void *arena_alloc(arena_t *a, size_t size, size_t align) {
+    uintptr_t p = ((uintptr_t)a->cur + align - 1) & ~(uintptr_t)(align - 1);
+    if (!a->cur || p + size > (uintptr_t)a->end) {
+        size_t want = size + align > a->block_size ? size + align : a->block_size;
+        struct ArenaBlock *b = malloc(offsetof(struct ArenaBlock, data) + want);
+        if (!b) return NULL;
+        b->next = a->head;
+        a->head = b;
+        a->cur = b->data;
+        a->end = b->data + want;
+        p = ((uintptr_t)a->cur + align - 1) & ~(uintptr_t)(align - 1);
+    }
+    a->cur = (char *)(p + size);
+    return (void *)p;
+}
+
+char *arena_strndup(arena_t *a, const char *s, size_t len) {
+    char *copy = arena_alloc(a, len + 1, 1);
+    if (!copy) return NULL;
+    memcpy(copy, s, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+void arena_free(arena_t *a) {
+    while (a->head) {
+        struct ArenaBlock *next = a->head->next;
+        free(a->head);
+        a->head = next;
+    }
+    a->cur = NULL;
+    a->end = NULL;
+}
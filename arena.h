@@ -0,0 +1,25 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Bump allocator: memory is carved from large blocks and released all at
+// once by arena_free(). Not thread-safe; use one arena per thread.
+
+struct ArenaBlock;
+
+typedef struct Arena {
+    struct ArenaBlock *head;
+    char  *cur;
+    char  *end;
+    size_t block_size;
+} arena_t;
+
+void  arena_init(arena_t *a, size_t block_size);
+// Returns NULL when a new block cannot be allocated.
+void *arena_alloc(arena_t *a, size_t size, size_t align);
+// Copies len bytes and appends a NUL.
+char *arena_strndup(arena_t *a, const char *s, size_t len);
+void  arena_free(arena_t *a);
+
+#endif
@@ -0,0 +1,119 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+
+#include "bench.h"
+#include "commands.h"
+#include "human.h"
+#include "layout.h"
+
+// _Atomic T may be larger or more aligned than T, and operations on it fall
+// back to a lock inside libatomic when no instruction covers the whole object.
+
+typedef struct Rgb {
+    char r, g, b;
+} rgb_t;
+
+typedef struct Pair {
+    int32_t lo, hi;
+} pair_t;
+
+typedef struct Triple {
+    int64_t a, b, c;
+} triple_t;
+
+typedef struct AtomicHuman1 {
+    char           first_initial;
+    int            age;
+    double         height;
+    _Atomic name_t name;
+} atomic_human1_t;
+
+#define ATOMIC_ROW(T) \
+    printf("%-10s %6zu %6zu %12zu %13zu %10s\n", #T, sizeof(T), alignof(T), \
+           sizeof(_Atomic T), alignof(_Atomic T), \
+           atomic_is_lock_free(&(_Atomic T){0}) ? "yes" : "no (lock)")
+
+void show_atomic_layouts(void) {
+    struct FieldDesc name_fields[] = {
+        FIELD(name_t, first, 'F'),
+        FIELD(name_t, last,  'L'),
+    };
+    struct FieldDesc rgb_fields[] = {
+        FIELD(rgb_t, r, 'R'),
+        FIELD(rgb_t, g, 'G'),
+        FIELD(rgb_t, b, 'B'),
+    };
+    struct FieldDesc atomic_human1_fields[] = {
+        FIELD(atomic_human1_t, first_initial, 'F'),
+        FIELD(atomic_human1_t, age,           'A'),
+        FIELD(atomic_human1_t, height,        'H'),
+        FIELD(atomic_human1_t, name,          'N'),
+    };
+
+    printf("\nAtomic layouts:\n");
+    printf("%-10s %6s %6s %12s %13s %10s\n", "T", "sizeof", "align", "sizeof(_At)",
+           "align(_At)", "lock-free");
+    ATOMIC_ROW(rgb_t);
+    ATOMIC_ROW(pair_t);
+    ATOMIC_ROW(name_t);
+    ATOMIC_ROW(triple_t);
+    ATOMIC_ROW(human1_t);
+
+    // An _Atomic struct has the same member offsets as T; only its size and
+    // alignment may grow, so T's descriptors are reused with _Atomic T's size.
+    visualize("name_t", sizeof(name_t), name_fields, NFIELDS(name_fields));
+    visualize("_Atomic name_t", sizeof(_Atomic name_t), name_fields, NFIELDS(name_fields));
+    visualize("rgb_t", sizeof(rgb_t), rgb_fields, NFIELDS(rgb_fields));
+    visualize("_Atomic rgb_t", sizeof(_Atomic rgb_t), rgb_fields, NFIELDS(rgb_fields));
+    visualize("AtomicHuman1", sizeof(atomic_human1_t), atomic_human1_fields,
+              NFIELDS(atomic_human1_fields));
+    padding_report("AtomicHuman1", sizeof(atomic_human1_t), alignof(atomic_human1_t),
+                   atomic_human1_fields, NFIELDS(atomic_human1_fields));
+}
+
+// Each kernel does a load, a store and a compare-exchange per iteration on a
+// single object, so the numbers are uncontended per-operation costs.
+#define ATOMIC_KERNEL(T, fname, mutate)                                         \
+    static double fname(size_t iters) {                                         \
+        static _Atomic T obj;                                                   \
+        T v = {0};                                                              \
+        uint64_t t0 = now_ns();                                                 \
+        for (size_t i = 0; i < iters; i++) {                                    \
+            T cur = atomic_load(&obj);                                          \
+            v = cur;                                                            \
+            mutate;                                                             \
+            atomic_store(&obj, v);                                              \
+            atomic_compare_exchange_strong(&obj, &v, cur);                      \
+        }                                                                       \
+        uint64_t t1 = now_ns();                                                 \
+        T last = atomic_load(&obj);                                             \
+        bench_sink += *(unsigned char *)&last;                                  \
+        return (double)(t1 - t0) / (double)iters / 3.0;                         \
+    }
+
+ATOMIC_KERNEL(int64_t,  run_int64,  v += 1)
+ATOMIC_KERNEL(rgb_t,    run_rgb,    v.r++)
+ATOMIC_KERNEL(pair_t,   run_pair,   v.lo++)
+ATOMIC_KERNEL(name_t,   run_name,   v.first++)
+ATOMIC_KERNEL(triple_t, run_triple, v.a++)
+
+int bench_atomic(int argc, char **argv) {
+    size_t iters = arg_count(argc, argv, 1, 10000000);
+
+    printf("Atomic operation cost (%zu iterations, ns/op over load+store+CAS):\n", iters);
+    printf("%-10s %7s %10s %8s\n", "T", "sizeof", "lock-free", "ns/op");
+    printf("%-10s %7zu %10s %8.2f\n", "int64_t", sizeof(_Atomic int64_t),
+           atomic_is_lock_free(&(_Atomic int64_t){0}) ? "yes" : "no", run_int64(iters));
+    printf("%-10s %7zu %10s %8.2f\n", "rgb_t", sizeof(_Atomic rgb_t),
+           atomic_is_lock_free(&(_Atomic rgb_t){0}) ? "yes" : "no", run_rgb(iters));
+    printf("%-10s %7zu %10s %8.2f\n", "pair_t", sizeof(_Atomic pair_t),
+           atomic_is_lock_free(&(_Atomic pair_t){0}) ? "yes" : "no", run_pair(iters));
+    printf("%-10s %7zu %10s %8.2f\n", "name_t", sizeof(_Atomic name_t),
+           atomic_is_lock_free(&(_Atomic name_t){0}) ? "yes" : "no", run_name(iters));
+    printf("%-10s %7zu %10s %8.2f\n", "triple_t", sizeof(_Atomic triple_t),
+           atomic_is_lock_free(&(_Atomic triple_t){0}) ? "yes" : "no", run_triple(iters));
+    return 0;
+}
@@ -0,0 +1,5 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench.h"
+
+volatile uint64_t bench_sink;
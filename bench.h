@@ -0,0 +1,30 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+// Timing helpers shared by the benchmark commands. Translation units that
+// include this must define _POSIX_C_SOURCE (or _GNU_SOURCE) first.
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+static inline uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// Optional positional count argument, e.g. `memory_padding bench-x 1000000`.
+static inline size_t arg_count(int argc, char **argv, int idx, size_t def) {
+    if (idx < argc) {
+        char *end;
+        unsigned long long v = strtoull(argv[idx], &end, 10);
+        if (*end == '\0' && v > 0) return (size_t)v;
+    }
+    return def;
+}
+
+// Results are folded in here so the optimizer cannot drop the measured work.
+extern volatile uint64_t bench_sink;
+
+#endif
@@ -0,0 +1,255 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BITPACK_X86 1
+#endif
+
+#include "bench.h"
+#include "bitpack.h"
+#include "commands.h"
+#include "human.h"
+
+unsigned bitpack_width(uint32_t max_value) {
+    unsigned bits = 1;
+    while (bits < 32 && (max_value >> bits) != 0) bits++;
+    return bits;
+}
+
+int bitpack_encode(bitpacked_t *bp, const uint32_t *values, size_t n, unsigned bits) {
+    size_t bytes = (n * bits + 7) / 8 + BITPACK_SLACK;
+
+    bp->count = n;
+    bp->bits = bits;
+    bp->data = NULL;
+    if (bits == 0 || bits > 32) return -1;
+    bp->data = calloc(bytes, 1);
+    if (!bp->data) return -1;
+
+    for (size_t i = 0; i < n; i++) {
+        size_t bit = i * bits;
+        uint64_t word;
+        // A wider value would spill into its neighbours.
+        if (bits < 32 && (values[i] >> bits) != 0) {
+            bitpack_free(bp);
+            return -1;
+        }
+        memcpy(&word, bp->data + bit / 8, sizeof word);
+        word |= (uint64_t)values[i] << (bit % 8);
+        memcpy(bp->data + bit / 8, &word, sizeof word);
+    }
+    return 0;
+}
+
+void bitpack_free(bitpacked_t *bp) {
+    free(bp->data);
+    bp->data = NULL;
+    bp->count = 0;
+}
+
+void bitpack_unpack_scalar(const bitpacked_t *bp, size_t begin, size_t n, uint32_t *out) {
+    const uint64_t mask = ((uint64_t)1 << bp->bits) - 1;
+    for (size_t i = 0; i < n; i++) {
+        size_t bit = (begin + i) * bp->bits;
+        uint64_t word;
+        memcpy(&word, bp->data + bit / 8, sizeof word);
+        out[i] = (uint32_t)((word >> (bit % 8)) & mask);
+    }
+}
+
+#ifdef BITPACK_X86
+// Eight values of `bits` bits occupy exactly `bits` bytes. The low 128-bit
+// lane decodes values 0-3 from the group's first bytes, the high lane values
+// 4-7 from byte (4 * bits) / 8 on. Per lane, a byte shuffle gathers the four
+// bytes covering each value into a 32-bit slot, a variable shift drops the
+// leading bits and a mask keeps `bits` of them. Valid for bits <= 25.
+__attribute__((target("avx2")))
+static void unpack_avx2(const bitpacked_t *bp, size_t begin, size_t n, uint32_t *out) {
+    const unsigned bits = bp->bits;
+    const size_t high_byte = (4 * bits) / 8;
+    uint8_t shuffle[32];
+    uint32_t shifts[8];
+    __m256i vshuffle, vshift, vmask;
+    size_t i = 0;
+
+    for (unsigned j = 0; j < 8; j++) {
+        unsigned lane_bit = j < 4 ? j * bits : j * bits - (unsigned)high_byte * 8;
+        for (unsigned b = 0; b < 4; b++) shuffle[j * 4 + b] = (uint8_t)(lane_bit / 8 + b);
+        shifts[j] = lane_bit % 8;
+    }
+    vshuffle = _mm256_loadu_si256((const __m256i *)shuffle);
+    vshift = _mm256_loadu_si256((const __m256i *)shifts);
+    vmask = _mm256_set1_epi32((int)(((uint64_t)1 << bits) - 1));
+
+    for (; i + 8 <= n; i += 8) {
+        const uint8_t *group = bp->data + (begin + i) / 8 * bits;
+        __m128i lo = _mm_loadu_si128((const __m128i *)group);
+        __m128i hi = _mm_loadu_si128((const __m128i *)(group + high_byte));
+        __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        v = _mm256_shuffle_epi8(v, vshuffle);
+        v = _mm256_srlv_epi32(v, vshift);
+        v = _mm256_and_si256(v, vmask);
+        _mm256_storeu_si256((__m256i *)(out + i), v);
+    }
+    if (i < n) bitpack_unpack_scalar(bp, begin + i, n - i, out + i);
+}
+#endif
+
+int bitpack_have_simd(void) {
+#ifdef BITPACK_X86
+    return __builtin_cpu_supports("avx2");
+#else
+    return 0;
+#endif
+}
+
+void bitpack_unpack(const bitpacked_t *bp, size_t begin, size_t n, uint32_t *out) {
+#ifdef BITPACK_X86
+    static int simd = -1;
+    if (simd < 0) simd = bitpack_have_simd();
+    if (simd && bp->bits <= 25) {
+        unpack_avx2(bp, begin, n, out);
+        return;
+    }
+#endif
+    bitpack_unpack_scalar(bp, begin, n, out);
+}
+
+// Scan benchmark: count adults (18..65) and sum ages, reading `age` from
+// the original records, from int/uint8 columns and from a 7-bit column.
+
+#define SCAN_BLOCK 1024
+
+struct ScanResult {
+    uint64_t adults;
+    uint64_t sum;
+};
+
+static inline void scan_block(const uint32_t *ages, size_t n, struct ScanResult *r) {
+    uint64_t adults = 0, sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        adults += ages[i] - 18u <= 47u;
+        sum += ages[i];
+    }
+    r->adults += adults;
+    r->sum += sum;
+}
+
+static struct ScanResult scan_rows(const human1_t *rows, size_t n) {
+    struct ScanResult r = {0, 0};
+    for (size_t i = 0; i < n; i++) {
+        uint32_t age = (uint32_t)rows[i].age;
+        r.adults += age - 18u <= 47u;
+        r.sum += age;
+    }
+    return r;
+}
+
+static struct ScanResult scan_int(const int *ages, size_t n) {
+    struct ScanResult r = {0, 0};
+    for (size_t i = 0; i < n; i++) {
+        uint32_t age = (uint32_t)ages[i];
+        r.adults += age - 18u <= 47u;
+        r.sum += age;
+    }
+    return r;
+}
+
+static struct ScanResult scan_u8(const uint8_t *ages, size_t n) {
+    struct ScanResult r = {0, 0};
+    for (size_t i = 0; i < n; i++) {
+        uint32_t age = ages[i];
+        r.adults += age - 18u <= 47u;
+        r.sum += age;
+    }
+    return r;
+}
+
+static struct ScanResult scan_packed(const bitpacked_t *bp,
+                                     void (*unpack)(const bitpacked_t *, size_t, size_t,
+                                                    uint32_t *)) {
+    struct ScanResult r = {0, 0};
+    uint32_t block[SCAN_BLOCK];
+    for (size_t begin = 0; begin < bp->count; begin += SCAN_BLOCK) {
+        size_t n = bp->count - begin < SCAN_BLOCK ? bp->count - begin : SCAN_BLOCK;
+        unpack(bp, begin, n, block);
+        scan_block(block, n, &r);
+    }
+    return r;
+}
+
+static void report(const char *label, size_t n, size_t bytes, uint64_t ns, struct ScanResult r,
+                   struct ScanResult expect) {
+    printf("%-22s %10.2f %9.1f %10.1f %8.2f%s\n", label, (double)bytes / (double)n,
+           (double)bytes / (1024.0 * 1024.0), (double)n / ((double)ns / 1e9) / 1e6,
+           (double)bytes / (double)ns, r.adults == expect.adults && r.sum == expect.sum ? "" : "  MISMATCH");
+    bench_sink += r.sum;
+}
+
+#define TIME_BEST(result, best, expr)                 \
+    do {                                              \
+        best = UINT64_MAX;                            \
+        for (int rep = 0; rep < 5; rep++) {           \
+            uint64_t t0 = now_ns();                   \
+            result = (expr);                          \
+            uint64_t dt = now_ns() - t0;              \
+            if (dt < best) best = dt;                 \
+        }                                             \
+    } while (0)
+
+int bench_bitpack(int argc, char **argv) {
+    size_t n = arg_count(argc, argv, 1, 16000000);
+    human1_t *rows = malloc(n * sizeof *rows);
+    int *ages = malloc(n * sizeof *ages);
+    uint8_t *ages8 = malloc(n);
+    uint32_t *tmp = malloc(n * sizeof *tmp);
+    bitpacked_t bp = {0, 0, NULL};
+    struct ScanResult expect, r;
+    uint64_t best;
+    int status = 1;
+
+    if (!rows || !ages || !ages8 || !tmp) {
+        fprintf(stderr, "bench-bitpack: cannot allocate %zu records\n", n);
+        goto out;
+    }
+    human_fill(rows, n, 11);
+    for (size_t i = 0; i < n; i++) {
+        ages[i] = rows[i].age;
+        ages8[i] = (uint8_t)rows[i].age;
+        tmp[i] = (uint32_t)rows[i].age;
+    }
+    if (bitpack_encode(&bp, tmp, n, bitpack_width(99)) != 0) {
+        fprintf(stderr, "bench-bitpack: cannot encode column\n");
+        goto out;
+    }
+
+    expect = scan_rows(rows, n);
+    printf("Scan of age over %zu records (%u-bit packing, best of 5):\n", n, bp.bits);
+    printf("%-22s %10s %9s %10s %8s\n", "column", "bytes/val", "MiB", "Mvals/s", "GB/s");
+
+    TIME_BEST(r, best, scan_rows(rows, n));
+    report("human1_t[].age", n, n * sizeof *rows, best, r, expect);
+    TIME_BEST(r, best, scan_int(ages, n));
+    report("int column", n, n * sizeof *ages, best, r, expect);
+    TIME_BEST(r, best, scan_u8(ages8, n));
+    report("uint8_t column", n, n, best, r, expect);
+    TIME_BEST(r, best, scan_packed(&bp, bitpack_unpack_scalar));
+    report("bit-packed scalar", n, (n * bp.bits + 7) / 8, best, r, expect);
+    if (bitpack_have_simd()) {
+        TIME_BEST(r, best, scan_packed(&bp, bitpack_unpack));
+        report("bit-packed avx2", n, (n * bp.bits + 7) / 8, best, r, expect);
+    }
+    status = 0;
+
+out:
+    bitpack_free(&bp);
+    free(rows);
+    free(ages);
+    free(ages8);
+    free(tmp);
+    return status;
+}
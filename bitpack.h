@@ -0,0 +1,32 @@
+#ifndef BITPACK_H
+#define BITPACK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Bit-packed unsigned column: `count` values of `bits` bits each, stored
+// LSB-first in a byte stream. The stream carries BITPACK_SLACK spare bytes
+// so unpack kernels can always load whole words past the last value.
+#define BITPACK_SLACK 32
+
+typedef struct BitPacked {
+    size_t   count;
+    unsigned bits;
+    uint8_t *data;
+} bitpacked_t;
+
+// Smallest width that holds max_value (at least 1 bit).
+unsigned bitpack_width(uint32_t max_value);
+
+// Returns 0 on success, -1 on allocation failure, a width outside 1..32 or a
+// value that does not fit in `bits` (nothing is left allocated).
+int  bitpack_encode(bitpacked_t *bp, const uint32_t *values, size_t n, unsigned bits);
+void bitpack_free(bitpacked_t *bp);
+
+// Unpacks values [begin, begin + n) into out; begin must be a multiple of 8.
+// Uses the AVX2 kernel when the CPU has it and bits <= 25.
+void bitpack_unpack(const bitpacked_t *bp, size_t begin, size_t n, uint32_t *out);
+void bitpack_unpack_scalar(const bitpacked_t *bp, size_t begin, size_t n, uint32_t *out);
+int  bitpack_have_simd(void);
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef COMMANDS_H
+#define COMMANDS_H
+
+// Sections of the default report.
+void show_atomic_layouts(void);
+
+// Subcommands: `memory_padding <name> [args...]`. argv[0] is the name.
+int bench_atomic(int argc, char **argv);
+int bench_query(int argc, char **argv);
+int bench_agg(int argc, char **argv);
+int bench_bitpack(int argc, char **argv);
+int bench_encoding(int argc, char **argv);
+int bench_parscan(int argc, char **argv);
+int bench_lookup(int argc, char **argv);
+int bench_csv(int argc, char **argv);
+int bench_loader(int argc, char **argv);
+int bench_pagecache(int argc, char **argv);
+int padding_files(int argc, char **argv);
+int bench_slotted(int argc, char **argv);
+int bench_wire(int argc, char **argv);
+int bench_cow(int argc, char **argv);
+int vec_report(int argc, char **argv);
+int sample_fields(int argc, char **argv);
+int bench_soavec(int argc, char **argv);
+int bench_packed(int argc, char **argv);
+int bench_optional(int argc, char **argv);
+int bench_tagged(int argc, char **argv);
+
+#endif
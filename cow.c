@@ -0,0 +1,297 @@
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "commands.h"
+#include "human.h"
+#include "layout.h"
+
+// Snapshot cost of a field update. A fork()-based snapshot (or an
+// incremental checkpoint) pays per page written, not per byte: after fork()
+// the first write to each shared page takes a copy-on-write fault and copies
+// 4 KiB. Updating `age` touches one page per 128 human1_t records, but only
+// one per 1024 records when the ages live in their own array.
+//
+// Dirtied pages are read from /proc/self/pagemap two ways: the soft-dirty
+// bit (bit 55, after writing "4" to /proc/self/clear_refs; needs
+// CONFIG_MEM_SOFT_DIRTY) and, while the snapshot child is alive, the
+// "exclusively mapped" bit (bit 56), which is set exactly on the pages the
+// parent has copied.
+
+#define PM_SOFT_DIRTY (1ull << 55)
+#define PM_EXCLUSIVE  (1ull << 56)
+#define PM_PRESENT    (1ull << 63)
+#define SPARSE_EVERY  100
+
+// Hot/cold split: the fields updated together stay in a small array.
+typedef struct HumanHot {
+    int32_t age;
+    char    first_initial;
+} human_hot_t;
+
+typedef struct HumanCold {
+    double height;
+    name_t name;
+} human_cold_t;
+
+struct Region {
+    void  *base;
+    size_t bytes;
+};
+
+struct CowLayout {
+    const char *name;
+    struct Region regions[4];  // every array of the layout
+    size_t nregions;
+    void  *ages;               // array written by the update
+    size_t stride;             // bytes between consecutive ages
+};
+
+static size_t page_size;
+
+// Page-aligned, populated anonymous memory without transparent huge pages, so
+// every count below is in 4 KiB pages.
+static void *alloc_region(size_t bytes) {
+    void *p = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) return NULL;
+    madvise(p, bytes, MADV_NOHUGEPAGE);
+    memset(p, 0, bytes);
+    return p;
+}
+
+static size_t region_pages(const struct Region *r) {
+    return (r->bytes + page_size - 1) / page_size;
+}
+
+// Counts pages of the region whose pagemap entry has all bits of `mask` set;
+// returns (size_t)-1 if the pagemap cannot be read.
+static size_t count_pages(int pagemap, const struct Region *r, uint64_t mask) {
+    size_t npages = region_pages(r), count = 0;
+    uint64_t entries[512];
+    off_t first = (off_t)((uintptr_t)r->base / page_size * sizeof(uint64_t));
+
+    for (size_t done = 0; done < npages;) {
+        size_t chunk = npages - done < 512 ? npages - done : 512;
+        ssize_t got = pread(pagemap, entries, chunk * sizeof entries[0],
+                            first + (off_t)(done * sizeof entries[0]));
+        if (got != (ssize_t)(chunk * sizeof entries[0])) return (size_t)-1;
+        for (size_t i = 0; i < chunk; i++) count += (entries[i] & mask) == mask;
+        done += chunk;
+    }
+    return count;
+}
+
+static int clear_soft_dirty(void) {
+    int fd = open("/proc/self/clear_refs", O_WRONLY);
+    int ok = fd >= 0 && write(fd, "4", 1) == 1;
+    if (fd >= 0) close(fd);
+    return ok ? 0 : -1;
+}
+
+// Soft dirty tracking is a kernel option; probe it on a page we write.
+static int soft_dirty_supported(int pagemap) {
+    struct Region probe = {alloc_region(page_size), page_size};
+    int supported;
+    if (!probe.base) return 0;
+    supported = clear_soft_dirty() == 0;
+    *(volatile char *)probe.base = 1;
+    supported = supported && count_pages(pagemap, &probe, PM_SOFT_DIRTY) == 1;
+    munmap(probe.base, probe.bytes);
+    return supported;
+}
+
+static void update_ages(const struct CowLayout *l, size_t n, const uint32_t *idx, size_t nidx) {
+    unsigned char *base = l->ages;
+    if (!idx) {
+        for (size_t i = 0; i < n; i++) (*(int32_t *)(base + i * l->stride))++;
+    } else {
+        for (size_t i = 0; i < nidx; i++) (*(int32_t *)(base + idx[i] * l->stride))++;
+    }
+}
+
+static size_t layout_count(int pagemap, const struct CowLayout *l, uint64_t mask) {
+    size_t total = 0;
+    for (size_t r = 0; r < l->nregions; r++) {
+        size_t c = count_pages(pagemap, &l->regions[r], mask);
+        if (c == (size_t)-1) return c;
+        total += c;
+    }
+    return total;
+}
+
+static long minor_faults(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_minflt;
+}
+
+// Forks a child that holds the snapshot until `release` is closed, updates
+// the ages in the parent and reports COW faults and copied pages. Prints the
+// failing call and returns -1 if the child cannot be started.
+static int measure(int pagemap, int soft_dirty, const struct CowLayout *l, size_t n,
+                   const uint32_t *idx, size_t nidx, const char *pattern) {
+    int release[2];
+    pid_t child;
+    long faults;
+    uint64_t t0, dt;
+    size_t copied, dirty = 0, total = 0;
+    char dirty_text[32];
+
+    for (size_t r = 0; r < l->nregions; r++) total += region_pages(&l->regions[r]);
+    if (soft_dirty) {
+        clear_soft_dirty();
+        update_ages(l, n, idx, nidx);
+        dirty = layout_count(pagemap, l, PM_SOFT_DIRTY);
+    }
+
+    if (pipe(release) != 0) {
+        perror("bench-cow: pipe");
+        return -1;
+    }
+    child = fork();
+    if (child < 0) {
+        perror("bench-cow: fork");
+        close(release[0]);
+        close(release[1]);
+        return -1;
+    }
+    if (child == 0) {
+        char c;
+        close(release[1]);
+        while (read(release[0], &c, 1) > 0) {
+        }
+        _exit(0);
+    }
+    close(release[0]);
+
+    faults = minor_faults();
+    t0 = now_ns();
+    update_ages(l, n, idx, nidx);
+    dt = now_ns() - t0;
+    faults = minor_faults() - faults;
+    copied = layout_count(pagemap, l, PM_EXCLUSIVE | PM_PRESENT);
+
+    close(release[1]);
+    waitpid(child, NULL, 0);
+
+    if (soft_dirty) {
+        snprintf(dirty_text, sizeof dirty_text, "%zu", dirty);
+    } else {
+        snprintf(dirty_text, sizeof dirty_text, "n/a");
+    }
+    printf("%-16s %-7s %9zu %11s %10ld %10zu %9.1f %9.2f\n", l->name, pattern, total, dirty_text,
+           faults, copied, (double)copied * (double)page_size / (1024.0 * 1024.0),
+           (double)dt / 1e6);
+    return 0;
+}
+
+int bench_cow(int argc, char **argv) {
+    size_t n = arg_count(argc, argv, 1, 2000000);
+    size_t nidx = n / SPARSE_EVERY;
+    human1_t *src = malloc(n * sizeof *src);
+    uint32_t *idx = malloc((nidx ? nidx : 1) * sizeof *idx);
+    human1_t *rows;
+    human_columns_t cols;
+    human_hot_t *hot;
+    human_cold_t *cold;
+    struct FieldDesc hot_fields[] = {
+        FIELD(human_hot_t, age,           'A'),
+        FIELD(human_hot_t, first_initial, 'F'),
+    };
+    struct FieldDesc cold_fields[] = {
+        FIELD(human_cold_t, height, 'H'),
+        FIELD(human_cold_t, name,   'N'),
+    };
+    uint64_t state = 0x853c49e6748fea9bu;
+    int pagemap, soft_dirty, status = 1;
+
+    page_size = (size_t)sysconf(_SC_PAGESIZE);
+    rows = alloc_region(n * sizeof *rows);
+    cols.count = n;
+    cols.first_initial = alloc_region(n * sizeof *cols.first_initial);
+    cols.age = alloc_region(n * sizeof *cols.age);
+    cols.height = alloc_region(n * sizeof *cols.height);
+    cols.name = alloc_region(n * sizeof *cols.name);
+    hot = alloc_region(n * sizeof *hot);
+    cold = alloc_region(n * sizeof *cold);
+    pagemap = open("/proc/self/pagemap", O_RDONLY);
+
+    if (!src || !idx || !rows || !cols.first_initial || !cols.age || !cols.height || !cols.name ||
+        !hot || !cold) {
+        fprintf(stderr, "bench-cow: cannot allocate %zu records\n", n);
+        goto out;
+    }
+    if (pagemap < 0) {
+        perror("bench-cow: /proc/self/pagemap");
+        goto out;
+    }
+    human_fill(src, n, 41);
+    memcpy(rows, src, n * sizeof *rows);
+    human_columns_from_rows(&cols, src);
+    for (size_t i = 0; i < n; i++) {
+        hot[i].age = src[i].age;
+        hot[i].first_initial = src[i].first_initial;
+        cold[i].height = src[i].height;
+        cold[i].name = src[i].name;
+    }
+    for (size_t i = 0; i < nidx; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        idx[i] = (uint32_t)(state % n);
+    }
+    soft_dirty = soft_dirty_supported(pagemap);
+
+    visualize("HumanHot", sizeof(human_hot_t), hot_fields, NFIELDS(hot_fields));
+    visualize("HumanCold", sizeof(human_cold_t), cold_fields, NFIELDS(cold_fields));
+
+    {
+        const struct CowLayout layouts[] = {
+            {"human1_t[]", {{rows, n * sizeof *rows}}, 1, &rows[0].age, sizeof *rows},
+            {"SoA columns",
+             {{cols.first_initial, n * sizeof *cols.first_initial},
+              {cols.age, n * sizeof *cols.age},
+              {cols.height, n * sizeof *cols.height},
+              {cols.name, n * sizeof *cols.name}},
+             4, cols.age, sizeof *cols.age},
+            {"hot/cold split", {{hot, n * sizeof *hot}, {cold, n * sizeof *cold}}, 2, &hot[0].age,
+             sizeof *hot},
+        };
+
+        printf("\nage += 1 after fork() on %zu records (all) and on 1 in %d records (sparse):\n", n,
+               SPARSE_EVERY);
+        printf("%-16s %-7s %9s %11s %10s %10s %9s %9s\n", "layout", "update", "pages",
+               "soft-dirty", "COW faults", "copied", "MiB", "ms");
+        for (size_t l = 0; l < sizeof layouts / sizeof layouts[0]; l++) {
+            if (measure(pagemap, soft_dirty, &layouts[l], n, NULL, 0, "all") != 0 ||
+                measure(pagemap, soft_dirty, &layouts[l], n, idx, nidx, "sparse") != 0) {
+                goto out;
+            }
+        }
+    }
+    if (!soft_dirty) {
+        printf("soft-dirty bits are not tracked by this kernel (CONFIG_MEM_SOFT_DIRTY)\n");
+    }
+    status = 0;
+
+out:
+    if (pagemap >= 0) close(pagemap);
+    if (rows) munmap(rows, n * sizeof *rows);
+    if (cols.first_initial) munmap(cols.first_initial, n * sizeof *cols.first_initial);
+    if (cols.age) munmap(cols.age, n * sizeof *cols.age);
+    if (cols.height) munmap(cols.height, n * sizeof *cols.height);
+    if (cols.name) munmap(cols.name, n * sizeof *cols.name);
+    if (hot) munmap(hot, n * sizeof *hot);
+    if (cold) munmap(cold, n * sizeof *cold);
+    free(src);
+    free(idx);
+    return status;
+}
@@ -0,0 +1,325 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "bench.h"
+#include "commands.h"
+#include "csv.h"
+
+#define CSV_MAX_THREADS 64
+
+// Next ',' or '\n' in [p, end), or end.
+static const char *find_delim(const char *p, const char *end) {
+#ifdef __SSE2__
+    const __m128i comma = _mm_set1_epi8(','), newline = _mm_set1_epi8('\n');
+    for (; p + 16 <= end; p += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, comma),
+                                                  _mm_cmpeq_epi8(v, newline)));
+        if (mask) return p + __builtin_ctz((unsigned)mask);
+    }
+#endif
+    for (; p < end; p++) {
+        if (*p == ',' || *p == '\n') return p;
+    }
+    return end;
+}
+
+size_t csv_count_rows(const char *buf, size_t len) {
+    const char *p = buf, *end = buf + len;
+    size_t rows = 0;
+#ifdef __SSE2__
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; p + 16 <= end; p += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        rows += (size_t)__builtin_popcount((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v, newline)));
+    }
+#endif
+    for (; p < end; p++) rows += *p == '\n';
+    // A final line without a newline still counts.
+    if (len > 0 && buf[len - 1] != '\n') rows++;
+    return rows;
+}
+
+// Numeric fields are an optional '-', at most CSV_MAX_DIGITS digits and, for
+// decimals, a '.' and at most CSV_MAX_DIGITS fraction digits. Anything else
+// fails the parse (-1) instead of loading a wrong value.
+#define CSV_MAX_DIGITS 9
+
+static const char *parse_digits(const char *p, const char *e, long *v) {
+    const char *start = p;
+    *v = 0;
+    for (; p < e && *p >= '0' && *p <= '9'; p++) {
+        if (p - start == CSV_MAX_DIGITS) return NULL;
+        *v = *v * 10 + (*p - '0');
+    }
+    return p > start ? p : NULL;
+}
+
+static int parse_int(const char *p, const char *e, int *out) {
+    int neg = p < e && *p == '-';
+    long v;
+    p = parse_digits(p + neg, e, &v);
+    if (!p || p != e) return -1;
+    *out = (int)(neg ? -v : v);
+    return 0;
+}
+
+static int parse_decimal(const char *p, const char *e, double *out) {
+    int neg = p < e && *p == '-';
+    long whole, frac = 0, scale = 1;
+    const char *q;
+    p = parse_digits(p + neg, e, &whole);
+    if (!p) return -1;
+    if (p < e && *p == '.') {
+        q = parse_digits(p + 1, e, &frac);
+        if (!q) return -1;
+        for (; p + 1 < q; p++) scale *= 10;
+        p = q;
+    }
+    if (p != e) return -1;
+    *out = ((double)whole + (double)frac / (double)scale) * (neg ? -1.0 : 1.0);
+    return 0;
+}
+
+struct CsvChunk {
+    const char *begin, *end;
+    size_t first_row;
+    size_t bad_rows;
+    int failed;
+    csv_result_t *out;
+    arena_t *arena;
+};
+
+static void store_row(csv_result_t *out, size_t i, const human1_t *h) {
+    switch (out->target) {
+    case CSV_HUMAN1:
+        out->rows1[i] = *h;
+        break;
+    case CSV_HUMAN2:
+        out->rows2[i] = (human2_t){h->name, h->height, h->age, h->first_initial};
+        break;
+    case CSV_COLUMNS:
+        out->cols.first_initial[i] = h->first_initial;
+        out->cols.age[i] = h->age;
+        out->cols.height[i] = h->height;
+        out->cols.name[i] = h->name;
+        break;
+    }
+}
+
+static void *parse_chunk(void *arg) {
+    struct CsvChunk *c = arg;
+    const char *p = c->begin;
+    size_t row = c->first_row;
+
+    while (p < c->end) {
+        const char *field[5], *field_end[5];
+        int nfields = 0, more = 0, bad;
+        human1_t h;
+
+        while (nfields < 5) {
+            const char *d = find_delim(p, c->end);
+            field[nfields] = p;
+            field_end[nfields] = d;
+            nfields++;
+            p = d < c->end ? d + 1 : d;
+            more = d < c->end && *d == ',';
+            if (!more) break;
+        }
+        memset(&h, 0, sizeof h);
+        bad = nfields < 5;
+        // Skip anything past the fifth field; such a row is malformed too.
+        if (more) {
+            while (p < c->end && *p != '\n') p++;
+            if (p < c->end) p++;
+            bad = 1;
+        }
+        // The initial is exactly one character.
+        if (field_end[0] - field[0] == 1) {
+            h.first_initial = *field[0];
+        } else {
+            bad = 1;
+        }
+        // Negative ages and heights are as malformed as unparsable ones.
+        if (nfields > 1 && (parse_int(field[1], field_end[1], &h.age) != 0 || h.age < 0)) {
+            h.age = 0;
+            bad = 1;
+        }
+        if (nfields > 2 &&
+            (parse_decimal(field[2], field_end[2], &h.height) != 0 || h.height < 0.0)) {
+            h.height = 0.0;
+            bad = 1;
+        }
+        c->bad_rows += bad;
+        if (nfields > 3) {
+            h.name.first = arena_strndup(c->arena, field[3], (size_t)(field_end[3] - field[3]));
+        }
+        if (nfields > 4) {
+            h.name.last = arena_strndup(c->arena, field[4], (size_t)(field_end[4] - field[4]));
+        }
+        if ((nfields > 3 && !h.name.first) || (nfields > 4 && !h.name.last)) {
+            c->failed = 1;
+            return NULL;
+        }
+        store_row(c->out, row++, &h);
+    }
+    return NULL;
+}
+
+int csv_ingest(const char *buf, size_t len, enum CsvTarget target, unsigned nthreads,
+               csv_result_t *out) {
+    struct CsvChunk chunks[CSV_MAX_THREADS];
+    pthread_t threads[CSV_MAX_THREADS];
+    unsigned started = 1;
+    const char *cut = buf;
+    int status = 0;
+
+    if (nthreads == 0) nthreads = 1;
+    if (nthreads > CSV_MAX_THREADS) nthreads = CSV_MAX_THREADS;
+    memset(out, 0, sizeof *out);
+    out->target = target;
+    out->count = csv_count_rows(buf, len);
+    out->arenas = malloc(nthreads * sizeof *out->arenas);
+    if (!out->arenas) return -1;
+    out->narenas = nthreads;
+    for (unsigned t = 0; t < nthreads; t++) arena_init(&out->arenas[t], 1 << 20);
+
+    switch (target) {
+    case CSV_HUMAN1:
+        out->rows1 = malloc(out->count * sizeof *out->rows1);
+        if (!out->rows1) status = -1;
+        break;
+    case CSV_HUMAN2:
+        out->rows2 = malloc(out->count * sizeof *out->rows2);
+        if (!out->rows2) status = -1;
+        break;
+    case CSV_COLUMNS:
+        status = human_columns_init(&out->cols, out->count);
+        break;
+    }
+    if (status != 0) {
+        csv_result_free(out);
+        return -1;
+    }
+
+    // Cut at the first newline after each even split; count the rows before
+    // each cut so every chunk knows where its output starts.
+    for (unsigned t = 0; t < nthreads; t++) {
+        const char *end = t + 1 == nthreads ? buf + len : buf + len / nthreads * (t + 1);
+        if (end < cut) end = cut;
+        if (t + 1 < nthreads) {
+            const char *nl = memchr(end, '\n', (size_t)(buf + len - end));
+            end = nl ? nl + 1 : buf + len;
+        }
+        chunks[t] = (struct CsvChunk){cut, end, 0, 0, 0, out, &out->arenas[t]};
+        if (t > 0) {
+            chunks[t].first_row = chunks[t - 1].first_row +
+                                  csv_count_rows(chunks[t - 1].begin,
+                                                 (size_t)(chunks[t - 1].end - chunks[t - 1].begin));
+        }
+        cut = end;
+    }
+
+    for (; started < nthreads; started++) {
+        if (pthread_create(&threads[started], NULL, parse_chunk, &chunks[started]) != 0) break;
+    }
+    parse_chunk(&chunks[0]);
+    // Chunks whose thread did not start are parsed here.
+    for (unsigned t = started; t < nthreads; t++) parse_chunk(&chunks[t]);
+    for (unsigned t = 1; t < started; t++) pthread_join(threads[t], NULL);
+
+    for (unsigned t = 0; t < nthreads; t++) {
+        out->bad_rows += chunks[t].bad_rows;
+        if (chunks[t].failed) status = -1;
+    }
+    if (status != 0) csv_result_free(out);
+    return status;
+}
+
+void csv_result_free(csv_result_t *res) {
+    free(res->rows1);
+    free(res->rows2);
+    if (res->cols.age) human_columns_free(&res->cols);
+    for (unsigned t = 0; t < res->narenas; t++) arena_free(&res->arenas[t]);
+    free(res->arenas);
+    memset(res, 0, sizeof *res);
+}
+
+// Benchmark: generate an in-memory export and ingest it into each target.
+
+static char *generate_csv(size_t rows, size_t *len) {
+    human1_t *tmp = malloc(rows * sizeof *tmp);
+    char *buf = malloc(rows * 48 + 1);
+    size_t pos = 0;
+
+    if (!tmp || !buf) {
+        free(tmp);
+        free(buf);
+        return NULL;
+    }
+    human_fill(tmp, rows, 99);
+    for (size_t i = 0; i < rows; i++) {
+        pos += (size_t)sprintf(buf + pos, "%c,%d,%.2f,%s,%s\n", tmp[i].first_initial, tmp[i].age,
+                               tmp[i].height, tmp[i].name.first, tmp[i].name.last);
+    }
+    free(tmp);
+    *len = pos;
+    return buf;
+}
+
+int bench_csv(int argc, char **argv) {
+    size_t rows = arg_count(argc, argv, 1, 4000000);
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned max_threads = (unsigned)arg_count(argc, argv, 2, ncpu > 0 ? (size_t)ncpu : 1);
+    static const struct {
+        const char *label;
+        enum CsvTarget target;
+    } targets[] = {
+        {"human1_t[]", CSV_HUMAN1},
+        {"human2_t[]", CSV_HUMAN2},
+        {"SoA columns", CSV_COLUMNS},
+    };
+    size_t len = 0;
+    char *buf = generate_csv(rows, &len);
+
+    if (!buf) {
+        fprintf(stderr, "bench-csv: cannot generate %zu rows\n", rows);
+        return 1;
+    }
+    printf("CSV ingestion of %zu rows, %.1f MiB (best of 3):\n", rows, (double)len / (1024.0 * 1024.0));
+    printf("%-12s %8s %10s %10s %10s\n", "target", "threads", "ms", "MB/s", "Mrows/s");
+    for (size_t t = 0; t < sizeof targets / sizeof targets[0]; t++) {
+        for (unsigned th = 1;; th = th * 2 < max_threads ? th * 2 : max_threads) {
+            uint64_t best = UINT64_MAX;
+            for (int rep = 0; rep < 3; rep++) {
+                csv_result_t res;
+                uint64_t t0 = now_ns(), dt;
+                if (csv_ingest(buf, len, targets[t].target, th, &res) != 0) {
+                    fprintf(stderr, "bench-csv: ingestion failed\n");
+                    free(buf);
+                    return 1;
+                }
+                dt = now_ns() - t0;
+                best = dt < best ? dt : best;
+                if (res.count != rows || res.bad_rows != 0) {
+                    fprintf(stderr, "bench-csv: parsed %zu rows, %zu bad\n", res.count, res.bad_rows);
+                }
+                csv_result_free(&res);
+            }
+            printf("%-12s %8u %10.1f %10.1f %10.2f\n", targets[t].label, th, (double)best / 1e6,
+                   (double)len / ((double)best / 1e9) / 1e6, (double)rows / ((double)best / 1e9) / 1e6);
+            if (th >= max_threads) break;
+        }
+    }
+    free(buf);
+    return 0;
+}
@@ -0,0 +1,34 @@
+#ifndef CSV_H
+#define CSV_H
+
+#include <stddef.h>
+
+#include "arena.h"
+#include "human.h"
+
+// CSV ingestion of `initial,age,height,first,last` rows (no header, no
+// quoting) into human1_t[], human2_t[] or SoA columns. Delimiters are found
+// 16 bytes at a time with SSE2 where available. The input is split into
+// one chunk per thread at line boundaries; names are copied into per-thread
+// arenas owned by the result.
+
+enum CsvTarget { CSV_HUMAN1, CSV_HUMAN2, CSV_COLUMNS };
+
+typedef struct CsvResult {
+    enum CsvTarget target;
+    size_t    count;
+    size_t    bad_rows;   // rows without exactly 5 well-formed fields; bad ones store 0
+    human1_t *rows1;
+    human2_t *rows2;
+    human_columns_t cols;
+    arena_t  *arenas;
+    unsigned  narenas;
+} csv_result_t;
+
+size_t csv_count_rows(const char *buf, size_t len);
+// Returns 0 on success, -1 on allocation or thread start failure.
+int    csv_ingest(const char *buf, size_t len, enum CsvTarget target, unsigned nthreads,
+                  csv_result_t *out);
+void   csv_result_free(csv_result_t *res);
+
+#endif
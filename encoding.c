@@ -0,0 +1,357 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "commands.h"
+#include "encoding.h"
+#include "human.h"
+
+// Open-addressing map from key to dictionary code, grown by doubling.
+struct KeyMap {
+    size_t    capacity;
+    size_t    used;
+    uint64_t *keys;
+    uint32_t *codes;
+    uint8_t  *full;
+};
+
+static inline size_t key_slot(uint64_t key, size_t mask) {
+    return (size_t)((key * 0x9e3779b97f4a7c15u) >> 17) & mask;
+}
+
+static int keymap_init(struct KeyMap *m, size_t capacity) {
+    m->capacity = capacity;
+    m->used = 0;
+    m->keys = malloc(capacity * sizeof *m->keys);
+    m->codes = malloc(capacity * sizeof *m->codes);
+    m->full = calloc(capacity, 1);
+    if (!m->keys || !m->codes || !m->full) {
+        free(m->keys);
+        free(m->codes);
+        free(m->full);
+        return -1;
+    }
+    return 0;
+}
+
+static void keymap_free(struct KeyMap *m) {
+    free(m->keys);
+    free(m->codes);
+    free(m->full);
+}
+
+static size_t keymap_find(const struct KeyMap *m, uint64_t key) {
+    size_t mask = m->capacity - 1, slot = key_slot(key, mask);
+    while (m->full[slot] && m->keys[slot] != key) slot = (slot + 1) & mask;
+    return slot;
+}
+
+static int keymap_insert(struct KeyMap *m, uint64_t key) {
+    size_t slot = keymap_find(m, key);
+    if (m->full[slot]) return 0;
+    if (2 * (m->used + 1) > m->capacity) {
+        struct KeyMap bigger;
+        if (keymap_init(&bigger, m->capacity * 2) != 0) return -1;
+        for (size_t i = 0; i < m->capacity; i++) {
+            if (m->full[i]) keymap_insert(&bigger, m->keys[i]);
+        }
+        keymap_free(m);
+        *m = bigger;
+        slot = keymap_find(m, key);
+    }
+    m->full[slot] = 1;
+    m->keys[slot] = key;
+    m->used++;
+    return 0;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+int dict_encode(dict_column_t *col, const uint64_t *keys, size_t n) {
+    struct KeyMap map;
+    uint32_t *codes = NULL;
+    size_t k = 0;
+    int status = -1;
+
+    col->ndict = 0;
+    col->dict = NULL;
+    col->codes.data = NULL;
+    if (keymap_init(&map, 1024) != 0) return -1;
+    for (size_t i = 0; i < n; i++) {
+        if (keymap_insert(&map, keys[i]) != 0) goto out;
+    }
+
+    col->dict = malloc(map.used * sizeof *col->dict);
+    codes = malloc(n * sizeof *codes);
+    if (!col->dict || !codes) goto out;
+    for (size_t i = 0; i < map.capacity; i++) {
+        if (map.full[i]) col->dict[k++] = map.keys[i];
+    }
+    qsort(col->dict, k, sizeof *col->dict, cmp_u64);
+    col->ndict = k;
+    for (size_t c = 0; c < k; c++) map.codes[keymap_find(&map, col->dict[c])] = (uint32_t)c;
+    for (size_t i = 0; i < n; i++) codes[i] = map.codes[keymap_find(&map, keys[i])];
+
+    status = bitpack_encode(&col->codes, codes, n, bitpack_width(k > 1 ? (uint32_t)(k - 1) : 0));
+
+out:
+    if (status != 0) {
+        free(col->dict);
+        col->dict = NULL;
+    }
+    free(codes);
+    keymap_free(&map);
+    return status;
+}
+
+void dict_decode(const dict_column_t *col, size_t begin, size_t n, uint64_t *out) {
+    uint32_t codes[ENCODING_BLOCK];
+    for (size_t done = 0; done < n; done += ENCODING_BLOCK) {
+        size_t m = n - done < ENCODING_BLOCK ? n - done : ENCODING_BLOCK;
+        bitpack_unpack(&col->codes, begin + done, m, codes);
+        for (size_t i = 0; i < m; i++) out[done + i] = col->dict[codes[i]];
+    }
+}
+
+uint32_t dict_lower_bound(const dict_column_t *col, uint64_t key) {
+    size_t lo = 0, hi = col->ndict;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (col->dict[mid] < key) lo = mid + 1;
+        else hi = mid;
+    }
+    return (uint32_t)lo;
+}
+
+void dict_free(dict_column_t *col) {
+    free(col->dict);
+    col->dict = NULL;
+    col->ndict = 0;
+    bitpack_free(&col->codes);
+}
+
+int block_encode(block_column_t *col, const uint32_t *values, size_t n, int delta) {
+    uint32_t offsets[ENCODING_BLOCK];
+
+    col->count = n;
+    col->nblocks = (n + ENCODING_BLOCK - 1) / ENCODING_BLOCK;
+    col->delta = delta;
+    col->base = malloc(col->nblocks * sizeof *col->base);
+    col->blocks = calloc(col->nblocks, sizeof *col->blocks);
+    if (!col->base || !col->blocks) {
+        block_free(col);
+        return -1;
+    }
+
+    for (size_t b = 0; b < col->nblocks; b++) {
+        const uint32_t *v = values + b * ENCODING_BLOCK;
+        size_t m = n - b * ENCODING_BLOCK < ENCODING_BLOCK ? n - b * ENCODING_BLOCK : ENCODING_BLOCK;
+        uint32_t base = v[0], max = 0;
+
+        // Delta blocks assume non-decreasing input; FOR blocks work on any.
+        if (!delta) {
+            for (size_t i = 1; i < m; i++) base = v[i] < base ? v[i] : base;
+        }
+        for (size_t i = 0; i < m; i++) {
+            offsets[i] = delta ? (i ? v[i] - v[i - 1] : 0) : v[i] - base;
+            max = offsets[i] > max ? offsets[i] : max;
+        }
+        col->base[b] = base;
+        if (bitpack_encode(&col->blocks[b], offsets, m, bitpack_width(max)) != 0) {
+            block_free(col);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+size_t block_decode(const block_column_t *col, size_t b, uint32_t *out) {
+    size_t m = col->blocks[b].count;
+    uint32_t base = col->base[b];
+    bitpack_unpack(&col->blocks[b], 0, m, out);
+    if (col->delta) {
+        for (size_t i = 0; i < m; i++) out[i] = base += out[i];
+    } else {
+        for (size_t i = 0; i < m; i++) out[i] += base;
+    }
+    return m;
+}
+
+size_t block_bytes(const block_column_t *col) {
+    size_t bytes = col->nblocks * (sizeof *col->base + 1);  // base + width byte
+    for (size_t b = 0; b < col->nblocks; b++) {
+        bytes += (col->blocks[b].count * col->blocks[b].bits + 7) / 8;
+    }
+    return bytes;
+}
+
+void block_free(block_column_t *col) {
+    if (col->blocks) {
+        for (size_t b = 0; b < col->nblocks; b++) bitpack_free(&col->blocks[b]);
+    }
+    free(col->base);
+    free(col->blocks);
+    col->base = NULL;
+    col->blocks = NULL;
+    col->nblocks = 0;
+}
+
+// Benchmark: the same aggregate over the raw records, a plain column and an
+// encoded column, plus encode time and size.
+
+static inline uint64_t height_key(double h) {
+    uint64_t key;
+    memcpy(&key, &h, sizeof key);
+    return key;
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+#define TIMED(ns, stmt)                   \
+    do {                                  \
+        uint64_t t0_ = now_ns();          \
+        stmt;                             \
+        ns = now_ns() - t0_;              \
+    } while (0)
+
+static void row(const char *label, size_t n, size_t bytes, uint64_t encode_ns, uint64_t scan_ns,
+                uint64_t result) {
+    printf("%-30s %9.3f %10.1f %10.1f %14llu\n", label, (double)bytes / (double)n,
+           (double)encode_ns / 1e6, (double)n / ((double)scan_ns / 1e9) / 1e6,
+           (unsigned long long)result);
+    bench_sink += result;
+}
+
+int bench_encoding(int argc, char **argv) {
+    size_t n = arg_count(argc, argv, 1, 8000000);
+    human1_t *rows = malloc(n * sizeof *rows);
+    human_columns_t cols = {0, NULL, NULL, NULL, NULL};
+    uint64_t *keys = malloc(n * sizeof *keys);
+    uint32_t *ints = malloc(n * sizeof *ints);
+    uint32_t block[ENCODING_BLOCK];
+    uint64_t decoded[ENCODING_BLOCK];
+    dict_column_t hdict = {0}, idict = {0};
+    block_column_t ages_for = {0}, heights_delta = {0};
+    uint64_t enc, scan, result;
+    int status = 1;
+
+    if (!rows || !keys || !ints || human_columns_init(&cols, n) != 0) {
+        fprintf(stderr, "bench-encoding: cannot allocate %zu records\n", n);
+        goto out;
+    }
+    human_fill(rows, n, 23);
+    human_columns_from_rows(&cols, rows);
+
+    printf("Encoded columns over %zu records:\n", n);
+    printf("%-30s %9s %10s %10s %14s\n", "column / query", "bytes/val", "encode ms", "Mvals/s",
+           "result");
+
+    // height >= 1.80: raw doubles vs a dictionary range on codes.
+    {
+        uint32_t from;
+        TIMED(scan, result = 0; for (size_t i = 0; i < n; i++) result += rows[i].height >= 1.80);
+        row("height>=1.80 human1_t[]", n, sizeof *rows * n, 0, scan, result);
+        TIMED(scan, result = 0; for (size_t i = 0; i < n; i++) result += cols.height[i] >= 1.80);
+        row("height>=1.80 double column", n, sizeof *cols.height * n, 0, scan, result);
+
+        for (size_t i = 0; i < n; i++) keys[i] = height_key(cols.height[i]);
+        TIMED(enc, if (dict_encode(&hdict, keys, n) != 0) goto nomem);
+        from = dict_lower_bound(&hdict, height_key(1.80));
+        TIMED(scan, result = 0; for (size_t b = 0; b < n; b += ENCODING_BLOCK) {
+            size_t m = n - b < ENCODING_BLOCK ? n - b : ENCODING_BLOCK;
+            bitpack_unpack(&hdict.codes, b, m, block);
+            for (size_t i = 0; i < m; i++) result += block[i] >= from;
+        });
+        row("height>=1.80 dict codes", n, (n * hdict.codes.bits + 7) / 8 + hdict.ndict * 8, enc,
+            scan, result);
+
+        // sum(height) has to decode back to doubles.
+        TIMED(scan, {
+            double sum = 0.0;
+            for (size_t b = 0; b < n; b += ENCODING_BLOCK) {
+                size_t m = n - b < ENCODING_BLOCK ? n - b : ENCODING_BLOCK;
+                dict_decode(&hdict, b, m, decoded);
+                for (size_t i = 0; i < m; i++) {
+                    double h;
+                    memcpy(&h, &decoded[i], sizeof h);
+                    sum += h;
+                }
+            }
+            result = (uint64_t)sum;
+        });
+        row("sum(height) dict decode", n, (n * hdict.codes.bits + 7) / 8 + hdict.ndict * 8, enc,
+            scan, result);
+    }
+
+    // first_initial == 'G'.
+    {
+        uint32_t code;
+        TIMED(scan, result = 0; for (size_t i = 0; i < n; i++) result += rows[i].first_initial == 'G');
+        row("initial=='G' human1_t[]", n, sizeof *rows * n, 0, scan, result);
+        TIMED(scan, result = 0; for (size_t i = 0; i < n; i++) result += cols.first_initial[i] == 'G');
+        row("initial=='G' char column", n, n, 0, scan, result);
+
+        for (size_t i = 0; i < n; i++) keys[i] = (unsigned char)cols.first_initial[i];
+        TIMED(enc, if (dict_encode(&idict, keys, n) != 0) goto nomem);
+        code = dict_lower_bound(&idict, 'G');
+        if (code < idict.ndict && idict.dict[code] != 'G') code = UINT32_MAX;
+        TIMED(scan, result = 0; for (size_t b = 0; b < n; b += ENCODING_BLOCK) {
+            size_t m = n - b < ENCODING_BLOCK ? n - b : ENCODING_BLOCK;
+            bitpack_unpack(&idict.codes, b, m, block);
+            for (size_t i = 0; i < m; i++) result += block[i] == code;
+        });
+        row("initial=='G' dict codes", n, (n * idict.codes.bits + 7) / 8 + idict.ndict * 8, enc,
+            scan, result);
+    }
+
+    // sum(age): int column vs frame of reference.
+    {
+        TIMED(scan, result = 0; for (size_t i = 0; i < n; i++) result += (uint64_t)cols.age[i]);
+        row("sum(age) int column", n, sizeof *cols.age * n, 0, scan, result);
+        for (size_t i = 0; i < n; i++) ints[i] = (uint32_t)cols.age[i];
+        TIMED(enc, if (block_encode(&ages_for, ints, n, 0) != 0) goto nomem);
+        TIMED(scan, result = 0; for (size_t b = 0; b < ages_for.nblocks; b++) {
+            size_t m = block_decode(&ages_for, b, block);
+            for (size_t i = 0; i < m; i++) result += block[i];
+        });
+        row("sum(age) FOR", n, block_bytes(&ages_for), enc, scan, result);
+    }
+
+    // sum(height in cm) over a column clustered by height: delta coding.
+    {
+        for (size_t i = 0; i < n; i++) ints[i] = (uint32_t)(cols.height[i] * 100.0 + 0.5);
+        qsort(ints, n, sizeof *ints, cmp_u32);
+        TIMED(scan, result = 0; for (size_t i = 0; i < n; i++) result += ints[i]);
+        row("sum(cm) sorted uint32 column", n, sizeof *ints * n, 0, scan, result);
+        TIMED(enc, if (block_encode(&heights_delta, ints, n, 1) != 0) goto nomem);
+        TIMED(scan, result = 0; for (size_t b = 0; b < heights_delta.nblocks; b++) {
+            size_t m = block_decode(&heights_delta, b, block);
+            for (size_t i = 0; i < m; i++) result += block[i];
+        });
+        row("sum(cm) sorted delta", n, block_bytes(&heights_delta), enc, scan, result);
+    }
+    status = 0;
+    goto out;
+
+nomem:
+    fprintf(stderr, "bench-encoding: encoding failed\n");
+out:
+    dict_free(&hdict);
+    dict_free(&idict);
+    block_free(&ages_for);
+    block_free(&heights_delta);
+    human_columns_free(&cols);
+    free(rows);
+    free(keys);
+    free(ints);
+    return status;
+}
@@ -0,0 +1,47 @@
+#ifndef ENCODING_H
+#define ENCODING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bitpack.h"
+
+// Lightweight encodings for SoA columns. Values are handled as unsigned
+// 64-bit keys: integers as themselves, non-negative doubles as their IEEE
+// bit pattern, which sorts in the same order as the numbers.
+
+#define ENCODING_BLOCK 1024
+
+// Dictionary: sorted distinct keys plus a bit-packed code per row. Because
+// the dictionary is sorted, range predicates become code ranges.
+typedef struct DictColumn {
+    size_t    ndict;
+    uint64_t *dict;
+    bitpacked_t codes;
+} dict_column_t;
+
+// Frame of reference or delta coding per ENCODING_BLOCK values: each block
+// stores a base and bit-packed offsets from it (FOR) or from the previous
+// value (delta, for sorted columns).
+typedef struct BlockColumn {
+    size_t       count;
+    size_t       nblocks;
+    int          delta;
+    uint32_t    *base;
+    bitpacked_t *blocks;
+} block_column_t;
+
+// All encoders return 0 on success and -1 on allocation failure.
+int  dict_encode(dict_column_t *col, const uint64_t *keys, size_t n);
+void dict_decode(const dict_column_t *col, size_t begin, size_t n, uint64_t *out);
+// First code whose key is >= key (ndict if none).
+uint32_t dict_lower_bound(const dict_column_t *col, uint64_t key);
+void dict_free(dict_column_t *col);
+
+int  block_encode(block_column_t *col, const uint32_t *values, size_t n, int delta);
+// Decodes block `b` (ENCODING_BLOCK values, fewer for the last) into out.
+size_t block_decode(const block_column_t *col, size_t b, uint32_t *out);
+size_t block_bytes(const block_column_t *col);
+void block_free(block_column_t *col);
+
+#endif
@@ -0,0 +1,326 @@
+#define _GNU_SOURCE
+
+#include <dirent.h>
+#include <errno.h>
+#include <linux/hw_breakpoint.h>
+#include <linux/perf_event.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "commands.h"
+#include "human.h"
+#include "layout.h"
+
+// Field access sampling in a running process, without recompiling it.
+// Given the address of an array of a known layout, the sampler repeatedly
+// picks a random instance and puts hardware breakpoints (perf_event_open,
+// PERF_TYPE_BREAKPOINT) on up to four of its fields for a short dwell, then
+// moves on, rotating through every (field, write / read-or-write) pair. x86
+// cannot trap reads alone, so reads are the read-or-write count minus the
+// write count. Per-instance rates times the number of instances estimate
+// the accesses per second of each field across the whole array.
+
+#define MAX_FIELDS    8
+#define MAX_SLOTS     4   // x86 debug address registers
+#define MAX_THREADS   64
+#define DWELL_NS      5000000ull
+#define DEMO_RECORDS  4096
+
+enum Watch { WATCH_W, WATCH_RW, WATCH_KINDS };
+
+struct SampleLayout {
+    const char *name;
+    size_t size;
+    struct FieldDesc fields[MAX_FIELDS];
+    size_t nfields;
+};
+
+struct FieldStats {
+    double hits[MAX_FIELDS][WATCH_KINDS];
+    double ns[MAX_FIELDS][WATCH_KINDS];  // time each pair was watched
+};
+
+// Demo workload counters, shared with the child through a MAP_SHARED page.
+struct DemoCounts {
+    volatile uint64_t reads[MAX_FIELDS];
+    volatile uint64_t writes[MAX_FIELDS];
+};
+
+// name_t is 16 bytes, longer than a breakpoint can cover, so its two
+// pointers are sampled as separate fields.
+static int find_layout(const char *name, struct SampleLayout *out) {
+    struct FieldDesc human1_fields[] = {
+        FIELD(human1_t, first_initial, 'F'),
+        FIELD(human1_t, age,           'A'),
+        FIELD(human1_t, height,        'H'),
+        FIELD(human1_t, name.first,    'N'),
+        FIELD(human1_t, name.last,     'L'),
+    };
+    struct FieldDesc human2_fields[] = {
+        FIELD(human2_t, name.first,    'N'),
+        FIELD(human2_t, name.last,     'L'),
+        FIELD(human2_t, height,        'H'),
+        FIELD(human2_t, age,           'A'),
+        FIELD(human2_t, first_initial, 'F'),
+    };
+    struct FieldDesc worst_fields[] = {
+        FIELD(human_worst_t, first_initial, 'F'),
+        FIELD(human_worst_t, height,        'H'),
+        FIELD(human_worst_t, age,           'A'),
+        FIELD(human_worst_t, name.first,    'N'),
+        FIELD(human_worst_t, name.last,     'L'),
+    };
+    struct FieldDesc slim_fields[] = {
+        FIELD(human_slim_t, height_cm,     'H'),
+        FIELD(human_slim_t, age,           'A'),
+        FIELD(human_slim_t, first_initial, 'F'),
+        FIELD(human_slim_t, name_id,       'N'),
+    };
+    const struct FieldDesc *fields;
+    size_t nfields;
+
+    if (strcmp(name, "human1_t") == 0) {
+        fields = human1_fields, nfields = NFIELDS(human1_fields), out->size = sizeof(human1_t);
+    } else if (strcmp(name, "human2_t") == 0) {
+        fields = human2_fields, nfields = NFIELDS(human2_fields), out->size = sizeof(human2_t);
+    } else if (strcmp(name, "human_worst_t") == 0) {
+        fields = worst_fields, nfields = NFIELDS(worst_fields), out->size = sizeof(human_worst_t);
+    } else if (strcmp(name, "human_slim_t") == 0) {
+        fields = slim_fields, nfields = NFIELDS(slim_fields), out->size = sizeof(human_slim_t);
+    } else {
+        return -1;
+    }
+    out->name = name;
+    out->nfields = nfields;
+    memcpy(out->fields, fields, nfields * sizeof fields[0]);
+    return 0;
+}
+
+static size_t list_threads(pid_t pid, pid_t *tids) {
+    char path[64];
+    struct dirent *e;
+    size_t n = 0;
+    DIR *d;
+
+    snprintf(path, sizeof path, "/proc/%d/task", (int)pid);
+    if (!(d = opendir(path))) return 0;
+    while ((e = readdir(d)) && n < MAX_THREADS) {
+        if (e->d_name[0] != '.') tids[n++] = (pid_t)atoi(e->d_name);
+    }
+    closedir(d);
+    return n;
+}
+
+static int open_breakpoint(pid_t tid, uint64_t addr, size_t len, enum Watch kind) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof attr);
+    attr.size = sizeof attr;
+    attr.type = PERF_TYPE_BREAKPOINT;
+    attr.bp_type = kind == WATCH_W ? HW_BREAKPOINT_W : HW_BREAKPOINT_RW;
+    attr.bp_addr = addr;
+    attr.bp_len = len >= 8 ? HW_BREAKPOINT_LEN_8 : len >= 4 ? HW_BREAKPOINT_LEN_4
+                : len >= 2 ? HW_BREAKPOINT_LEN_2 : HW_BREAKPOINT_LEN_1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, tid, -1, -1, 0);
+}
+
+static void sleep_ns(uint64_t ns) {
+    struct timespec ts = {(time_t)(ns / 1000000000u), (long)(ns % 1000000000u)};
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+// Samples `count` instances at `base` in process `pid` for `seconds`.
+// Returns 0 on success, -1 if no breakpoint could be placed.
+static int sample(pid_t pid, uint64_t base, size_t count, const struct SampleLayout *L,
+                  double seconds, struct FieldStats *st) {
+    pid_t tids[MAX_THREADS];
+    size_t nthreads = list_threads(pid, tids), pair = 0;
+    size_t npairs = L->nfields * WATCH_KINDS;
+    uint64_t state = 0x9e3779b97f4a7c15u ^ (uint64_t)pid, end;
+    int placed = 0;
+
+    if (nthreads == 0) return -1;
+    memset(st, 0, sizeof *st);
+    end = now_ns() + (uint64_t)(seconds * 1e9);
+    while (now_ns() < end) {
+        int fds[MAX_SLOTS][MAX_THREADS];
+        size_t slot_pair[MAX_SLOTS], nslots = 0, inst;
+        uint64_t t0, dt;
+
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        inst = state % count;
+        // Each breakpoint uses a debug register in every thread it watches.
+        for (; nslots < MAX_SLOTS && nslots < npairs; nslots++, pair = (pair + 1) % npairs) {
+            const struct FieldDesc *f = &L->fields[pair / WATCH_KINDS];
+            uint64_t addr = base + inst * L->size + f->offset;
+            slot_pair[nslots] = pair;
+            for (size_t t = 0; t < nthreads; t++) {
+                fds[nslots][t] = open_breakpoint(tids[t], addr, f->size,
+                                                 (enum Watch)(pair % WATCH_KINDS));
+                placed |= fds[nslots][t] >= 0;
+            }
+        }
+        t0 = now_ns();
+        sleep_ns(DWELL_NS);
+        dt = now_ns() - t0;
+        for (size_t s = 0; s < nslots; s++) {
+            size_t field = slot_pair[s] / WATCH_KINDS, kind = slot_pair[s] % WATCH_KINDS;
+            for (size_t t = 0; t < nthreads; t++) {
+                uint64_t hits;
+                if (fds[s][t] < 0) continue;
+                if (read(fds[s][t], &hits, sizeof hits) == sizeof hits) {
+                    st->hits[field][kind] += (double)hits;
+                }
+                close(fds[s][t]);
+            }
+            st->ns[field][kind] += (double)dt;
+        }
+        if (!placed) return -1;
+    }
+    return 0;
+}
+
+// Per-second estimates for the whole array.
+static void estimate(const struct FieldStats *st, const struct SampleLayout *L, size_t count,
+                     double *reads, double *writes) {
+    for (size_t f = 0; f < L->nfields; f++) {
+        double w = st->ns[f][WATCH_W] > 0 ? st->hits[f][WATCH_W] / st->ns[f][WATCH_W] : 0;
+        double rw = st->ns[f][WATCH_RW] > 0 ? st->hits[f][WATCH_RW] / st->ns[f][WATCH_RW] : 0;
+        writes[f] = w * 1e9 * (double)count;
+        reads[f] = rw > w ? (rw - w) * 1e9 * (double)count : 0;
+    }
+}
+
+// Demo target: random records, age read on every visit, height for ages
+// over 80, age written on every 16th visit, name.first on every 256th and
+// first_initial and name.last never.
+static void demo_workload(volatile human1_t *rows, size_t n, struct DemoCounts *counts) {
+    uint64_t state = 0x2545f4914f6cdd1du, acc = 0;
+    for (uint64_t iter = 0;; iter++) {
+        volatile human1_t *h;
+        int age;
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        h = &rows[state % n];
+        age = h->age;
+        counts->reads[1]++;
+        if (age > 80) {
+            acc += (uint64_t)h->height;
+            counts->reads[2]++;
+        }
+        if ((iter & 15) == 0) {
+            h->age = (age + 1) % 100;
+            counts->writes[1]++;
+        }
+        if ((iter & 255) == 0) {
+            acc += (uint64_t)(uintptr_t)h->name.first;
+            counts->reads[3]++;
+        }
+        bench_sink = acc;
+    }
+}
+
+int sample_fields(int argc, char **argv) {
+    struct SampleLayout L;
+    struct FieldStats st;
+    struct DemoCounts *counts = NULL, before;
+    double reads[MAX_FIELDS], writes[MAX_FIELDS], seconds;
+    pid_t pid, child = 0;
+    uint64_t base, t0 = 0;
+    size_t count;
+    char title[128];
+    int status = 1;
+
+    if (argc > 1 && argc < 5) {
+        fprintf(stderr, "usage: sample-fields [pid address count layout [seconds]]\n"
+                        "layouts: human1_t human2_t human_worst_t human_slim_t\n");
+        return 1;
+    }
+    if (argc > 1) {
+        pid = (pid_t)atoi(argv[1]);
+        base = strtoull(argv[2], NULL, 0);
+        count = arg_count(argc, argv, 3, 1);
+        if (find_layout(argv[4], &L) != 0) {
+            fprintf(stderr, "sample-fields: unknown layout %s\n", argv[4]);
+            return 1;
+        }
+        seconds = argc > 5 ? atof(argv[5]) : 2.0;
+    } else {
+        // No target given: sample a child running demo_workload().
+        int ready[2];
+        human1_t *rows = malloc(DEMO_RECORDS * sizeof *rows);
+        counts = mmap(NULL, sizeof *counts, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS,
+                      -1, 0);
+        if (!rows || counts == MAP_FAILED || pipe(ready) != 0) {
+            fprintf(stderr, "sample-fields: cannot set up the demo\n");
+            free(rows);
+            goto out;
+        }
+        human_fill(rows, DEMO_RECORDS, 5);
+        child = fork();
+        if (child == 0) {
+            close(ready[0]);
+            if (write(ready[1], "x", 1) != 1) _exit(1);
+            demo_workload(rows, DEMO_RECORDS, counts);
+        }
+        close(ready[1]);
+        if (child < 0 || read(ready[0], title, 1) != 1) {
+            perror(child < 0 ? "sample-fields: fork" : "sample-fields: demo workload");
+            close(ready[0]);
+            free(rows);
+            goto out;
+        }
+        close(ready[0]);
+        find_layout("human1_t", &L);
+        pid = child;
+        base = (uint64_t)(uintptr_t)rows;  // same address in the forked child
+        count = DEMO_RECORDS;
+        seconds = 2.0;
+        before = *counts;
+        t0 = now_ns();
+        free(rows);
+    }
+
+    if (sample(pid, base, count, &L, seconds, &st) != 0) {
+        fprintf(stderr, "sample-fields: cannot place breakpoints in pid %d: %s\n", (int)pid,
+                strerror(errno));
+        goto out;
+    }
+    estimate(&st, &L, count, reads, writes);
+    snprintf(title, sizeof title, "%s x %zu in pid %d, sampled %.1f s", L.name, count, (int)pid,
+             seconds);
+    visualize_heat(title, L.size, L.fields, L.nfields, reads, writes);
+
+    if (counts) {
+        double dt = (double)(now_ns() - t0) / 1e9;
+        printf("\ndemo workload, counted by the workload itself:\n");
+        printf("%-16s %14s %14s\n", "field", "reads/s", "writes/s");
+        for (size_t f = 0; f < L.nfields; f++) {
+            printf("%-16s %14.0f %14.0f\n", L.fields[f].name,
+                   (double)(counts->reads[f] - before.reads[f]) / dt,
+                   (double)(counts->writes[f] - before.writes[f]) / dt);
+        }
+    }
+    status = 0;
+
+out:
+    if (child > 0) {
+        kill(child, SIGKILL);
+        waitpid(child, NULL, 0);
+    }
+    if (counts && counts != MAP_FAILED) munmap(counts, sizeof *counts);
+    return status;
+}
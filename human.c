@@ -0,0 +1,95 @@
+#include <stdlib.h>
+
+#include "human.h"
+
+static char *first_names[] = {
+    "Ada", "Alan", "Barbara", "Claude", "Dennis", "Edsger", "Frances", "Grace",
+    "Hedy", "Ken", "Linus", "Margaret", "Niklaus", "Radia", "Tim", "Yukihiro",
+};
+static char *last_names[] = {
+    "Lovelace", "Turing", "Liskov", "Shannon", "Ritchie", "Dijkstra", "Allen", "Hopper",
+    "Lamarr", "Thompson", "Torvalds", "Hamilton", "Wirth", "Perlman", "Berners-Lee", "Matsumoto",
+};
+
+static uint64_t xorshift64(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+void human_fill(human1_t *rows, size_t n, uint64_t seed) {
+    uint64_t state = seed ? seed : 0x9e3779b97f4a7c15u;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t r = xorshift64(&state);
+        size_t first = r % 16, last = (r >> 4) % 16;
+        rows[i].name.first = first_names[first];
+        rows[i].name.last = last_names[last];
+        rows[i].first_initial = first_names[first][0];
+        rows[i].age = (int)((r >> 8) % 100);
+        // Heights in centimetre steps between 1.40 m and 2.10 m.
+        rows[i].height = 1.40 + (double)((r >> 16) % 71) / 100.0;
+    }
+}
+
+void human_to_human2(human2_t *out, const human1_t *rows, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i].name = rows[i].name;
+        out[i].height = rows[i].height;
+        out[i].age = rows[i].age;
+        out[i].first_initial = rows[i].first_initial;
+    }
+}
+
+void human_to_worst(human_worst_t *out, const human1_t *rows, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i].first_initial = rows[i].first_initial;
+        out[i].height = rows[i].height;
+        out[i].age = rows[i].age;
+        out[i].name = rows[i].name;
+    }
+}
+
+void human_to_slim(human_slim_t *out, const human1_t *rows, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i].height_cm = (uint16_t)(rows[i].height * 100.0 + 0.5);
+        out[i].age = (uint8_t)rows[i].age;
+        out[i].first_initial = rows[i].first_initial;
+        out[i].name_id = (uint32_t)i;
+    }
+}
+
+int human_columns_init(human_columns_t *cols, size_t n) {
+    cols->count = n;
+    cols->first_initial = malloc(n * sizeof *cols->first_initial);
+    cols->age = malloc(n * sizeof *cols->age);
+    cols->height = malloc(n * sizeof *cols->height);
+    cols->name = malloc(n * sizeof *cols->name);
+    if (!cols->first_initial || !cols->age || !cols->height || !cols->name) {
+        human_columns_free(cols);
+        return -1;
+    }
+    return 0;
+}
+
+void human_columns_from_rows(human_columns_t *cols, const human1_t *rows) {
+    for (size_t i = 0; i < cols->count; i++) {
+        cols->first_initial[i] = rows[i].first_initial;
+        cols->age[i] = rows[i].age;
+        cols->height[i] = rows[i].height;
+        cols->name[i] = rows[i].name;
+    }
+}
+
+void human_columns_free(human_columns_t *cols) {
+    free(cols->first_initial);
+    free(cols->age);
+    free(cols->height);
+    free(cols->name);
+    cols->first_initial = NULL;
+    cols->age = NULL;
+    cols->height = NULL;
+    cols->name = NULL;
+    cols->count = 0;
+}
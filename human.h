@@ -0,0 +1,67 @@
+#ifndef HUMAN_H
+#define HUMAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "padcheck.h"
+
+typedef struct Name {
+    char* first;
+    char* last;
+} name_t;
+
+typedef struct PADCHECK_HOT(32) Human1 {
+    char   first_initial;
+    int    age;
+    double height;
+    name_t name;
+} human1_t;
+
+typedef struct PADCHECK_HOT(32) Human2 {
+    name_t name;
+    double height;
+    int    age;
+    char   first_initial;
+} human2_t;
+
+// The same fields in the worst declaration order: 40 bytes.
+typedef struct HumanWorst {
+    char   first_initial;
+    double height;
+    int    age;
+    name_t name;
+} human_worst_t;
+
+// Narrowed fields: height in centimetres and a name id instead of two
+// pointers. 8 bytes and pointer-free, so it can be written to files as is.
+typedef struct PADCHECK_HOT(8) HumanSlim {
+    uint16_t height_cm;
+    uint8_t  age;
+    char     first_initial;
+    uint32_t name_id;
+} human_slim_t;
+
+// Column-wise (SoA) storage of the same records: one array per field.
+typedef struct HumanColumns {
+    size_t  count;
+    char   *first_initial;
+    int    *age;
+    double *height;
+    name_t *name;
+} human_columns_t;
+
+// Fills `rows` with deterministic pseudo-random humans. Names point into a
+// static pool, so the records own no memory.
+void human_fill(human1_t *rows, size_t n, uint64_t seed);
+void human_to_human2(human2_t *out, const human1_t *rows, size_t n);
+void human_to_worst(human_worst_t *out, const human1_t *rows, size_t n);
+// name_id is the record index.
+void human_to_slim(human_slim_t *out, const human1_t *rows, size_t n);
+
+// Returns 0 on success, -1 if an allocation failed (nothing is left allocated).
+int  human_columns_init(human_columns_t *cols, size_t n);
+void human_columns_from_rows(human_columns_t *cols, const human1_t *rows);
+void human_columns_free(human_columns_t *cols);
+
+#endif
@@ -0,0 +1,382 @@
+#include <stdio.h>
+#include <stdalign.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "layout.h"
+
+static char element_tag(char tag, size_t element) {
+    if (element % 2 == 0) return tag;
+    return (tag >= 'A' && tag <= 'Z') ? (char)(tag - 'A' + 'a') : tag;
+}
+
+static void print_field_name(const struct FieldDesc *f) {
+    if (f->fam) {
+        printf("%s[]", f->name);
+    } else if (f->inner) {
+        printf("%s[%zu][%zu]", f->name, f->size / f->elem_size / f->inner, f->inner);
+    } else if (f->elem_size != f->size) {
+        printf("%s[%zu]", f->name, f->size / f->elem_size);
+    } else {
+        printf("%s", f->name);
+    }
+}
+
+#define MAX_ROWS  8
+#define MAX_DEPTH 8
+
+// Assigns each member the row it is drawn on: the first alternative of a
+// union shares its parent's row, every further alternative gets a new one.
+static size_t assign_rows(const struct FieldDesc *fields, size_t nfields, size_t *rows) {
+    size_t frame_row[MAX_DEPTH] = {0}, frame_children[MAX_DEPTH] = {0};
+    enum FieldKind frame_kind[MAX_DEPTH] = {FD_STRUCT};
+    size_t depth = 0, nrows = 1;
+
+    for (size_t f = 0; f < nfields; f++) {
+        size_t row = frame_row[depth];
+        if (fields[f].kind == FD_END) {
+            if (depth > 0) depth--;
+            continue;
+        }
+        if (frame_kind[depth] == FD_UNION && frame_children[depth]++ > 0 && nrows < MAX_ROWS) {
+            row = nrows++;
+        }
+        rows[f] = row;
+        if (fields[f].kind != FD_MEMBER && depth + 1 < MAX_DEPTH) {
+            depth++;
+            frame_kind[depth] = fields[f].kind;
+            frame_row[depth] = row;
+            frame_children[depth] = 0;
+        }
+    }
+    return nrows;
+}
+
+static const struct FieldDesc *find_fam(const struct FieldDesc *fields, size_t nfields) {
+    for (size_t f = 0; f < nfields; f++) {
+        if (fields[f].fam) return &fields[f];
+    }
+    return NULL;
+}
+
+void visualize_var(const char *title, size_t sz, const struct FieldDesc *fields, size_t nfields,
+                   size_t ntrailing) {
+    char mem[MAX_ROWS][256];
+    size_t rows[256];
+    const struct FieldDesc *fam = find_fam(fields, nfields);
+    size_t fam_end = fam ? fam->offset + ntrailing * fam->elem_size : 0;
+    size_t total = fam_end > sz ? fam_end : sz;
+    size_t nrows, group_children[MAX_DEPTH] = {0};
+    int shadowed = 0;
+    enum FieldKind group_kind[MAX_DEPTH] = {FD_STRUCT};
+
+    if (total > sizeof mem[0] || nfields > sizeof rows / sizeof rows[0]) {
+        printf("%s: struct too large to visualize (%zu bytes)\n", title, total);
+        return;
+    }
+
+    nrows = assign_rows(fields, nfields, rows);
+    for (size_t r = 0; r < nrows; r++) {
+        for (size_t i = 0; i < total; i++) mem[r][i] = r ? ' ' : 'P';
+    }
+
+    // Array elements alternate case so element boundaries stay visible.
+    for (size_t f = 0; f < nfields; f++) {
+        size_t bytes = fields[f].fam ? ntrailing * fields[f].elem_size : fields[f].size;
+        if (fields[f].kind != FD_MEMBER) continue;
+        for (size_t i = 0; i < bytes; i++) {
+            mem[rows[f]][fields[f].offset + i] = element_tag(fields[f].tag, i / fields[f].elem_size);
+        }
+    }
+
+    // Bytes covered only by a later union alternative are not padding.
+    for (size_t r = 1; r < nrows; r++) {
+        for (size_t i = 0; i < total; i++) {
+            if (mem[r][i] != ' ' && mem[0][i] == 'P') {
+                mem[0][i] = '.';
+                shadowed = 1;
+            }
+        }
+    }
+
+    if (fam) {
+        printf("\n%s: size=%zu bytes (+%zu x %zu trailing = %zu bytes)\n", title, sz, ntrailing,
+               fam->elem_size, fam_end);
+    } else {
+        printf("\n%s: size=%zu bytes\n", title, sz);
+    }
+    printf("Offsets: ");
+    for (size_t f = 0, depth = 0; f < nfields; f++) {
+        if (fields[f].kind == FD_END) {
+            printf("} ");
+            if (depth > 0) depth--;
+            continue;
+        }
+        if (depth > 0 && group_kind[depth] == FD_UNION && group_children[depth]++ > 0) {
+            printf("| ");
+        }
+        if (fields[f].kind == FD_MEMBER) {
+            printf("%s@%zu ", fields[f].name, fields[f].offset);
+        } else {
+            printf("%s{ ", fields[f].name);
+            if (depth + 1 < MAX_DEPTH) {
+                depth++;
+                group_kind[depth] = fields[f].kind;
+                group_children[depth] = 0;
+            }
+        }
+    }
+    printf("\n");
+
+    for (size_t i = 0; i < total; i++) {
+        printf("%2zu |", i);
+    }
+    printf("\n");
+    for (size_t r = 0; r < nrows; r++) {
+        for (size_t i = 0; i < total; i++) {
+            printf(" %c |", mem[r][i]);
+        }
+        printf("\n");
+    }
+    printf("\nLegend: ");
+    for (size_t f = 0; f < nfields; f++) {
+        if (fields[f].kind != FD_MEMBER) continue;
+        printf("%c=", fields[f].tag);
+        print_field_name(&fields[f]);
+        printf(" ");
+    }
+    printf("P=padding%s\n", shadowed ? " .=union bytes shown below" : "");
+}
+
+void visualize(const char *title, size_t sz, const struct FieldDesc *fields, size_t nfields) {
+    visualize_var(title, sz, fields, nfields, 0);
+}
+
+void visualize_heat(const char *title, size_t sz, const struct FieldDesc *fields, size_t nfields,
+                    const double *reads, const double *writes) {
+    static const char levels[] = " .:-=+*#%@";
+    char heat[256];
+    double hottest = 0, all = 0;
+
+    visualize(title, sz, fields, nfields);
+    if (sz > sizeof heat) return;
+    for (size_t f = 0; f < nfields; f++) {
+        double total = reads[f] + writes[f];
+        if (fields[f].kind != FD_MEMBER) continue;
+        if (total > hottest) hottest = total;
+        all += total;
+    }
+    memset(heat, ' ', sz);
+    for (size_t f = 0; f < nfields; f++) {
+        double total = reads[f] + writes[f];
+        size_t level = 0;
+        if (fields[f].kind != FD_MEMBER) continue;
+        if (total > 0 && hottest > 0) level = 1 + (size_t)(total / hottest * (sizeof levels - 3));
+        for (size_t i = 0; i < fields[f].size && fields[f].offset + i < sz; i++) {
+            heat[fields[f].offset + i] = levels[level];
+        }
+    }
+    for (size_t i = 0; i < sz; i++) printf(" %c |", heat[i]);
+    printf("  <- accesses, '@' = hottest\n");
+    printf("%-16s %14s %14s %7s\n", "field", "reads/s", "writes/s", "share");
+    for (size_t f = 0; f < nfields; f++) {
+        if (fields[f].kind != FD_MEMBER) continue;
+        printf("%-16s %14.0f %14.0f %6.1f%%\n", fields[f].name, reads[f], writes[f],
+               all > 0 ? 100.0 * (reads[f] + writes[f]) / all : 0.0);
+    }
+}
+
+void visualize_columns(const char *title, const struct ColumnDesc *cols, size_t ncols,
+                       size_t count, size_t capacity) {
+    size_t total = 0, record = 0;
+
+    for (size_t c = 0; c < ncols; c++) record += cols[c].elem_size;
+    printf("\n%s: %zu columns, count=%zu capacity=%zu\n", title, ncols, count, capacity);
+    printf("%-16s %5s %12s %10s %7s  %s\n", "column", "elem", "bytes", "addr align", "per 64B",
+           "first cache line");
+    for (size_t c = 0; c < ncols; c++) {
+        uintptr_t addr = (uintptr_t)cols[c].data;
+        size_t align = addr ? (size_t)(addr & -addr) : 0;
+        size_t elem = cols[c].elem_size, bytes = capacity * elem;
+        size_t start = addr % 64;  // where the column begins in its first line
+        char tag = cols[c].tag >= 'a' && cols[c].tag <= 'z' ? (char)(cols[c].tag - 'a' + 'A')
+                                                           : cols[c].tag;
+        total += bytes;
+        printf("%-16s %5zu %12zu %10zu %7zu  ", cols[c].name, elem, bytes,
+               align > 4096 ? 4096 : align, elem ? 64 / elem : 0);
+        for (size_t i = 0; i < 64; i++) {
+            int in_column = elem && i >= start && i - start < bytes;
+            putchar(in_column ? element_tag(tag, (i - start) / elem) : '.');
+        }
+        printf("\n");
+    }
+    printf("%zu bytes per record across the columns, %zu allocated\n", record, total);
+}
+
+void visualize_bits(const char *title, unsigned width, const struct BitRange *ranges,
+                    size_t nranges) {
+    printf("\n%s: %u bits\n", title, width);
+    printf("byte ");
+    for (unsigned byte = width / 8; byte-- > 0;) printf(" %8u", byte);
+    printf("\nbits |");
+    for (unsigned bit = width; bit-- > 0;) {
+        char tag = '.';
+        for (size_t r = 0; r < nranges; r++) {
+            if (bit >= ranges[r].lo && bit < ranges[r].lo + ranges[r].bits) tag = ranges[r].tag;
+        }
+        putchar(tag);
+        if (bit % 8 == 0) putchar('|');
+    }
+    printf("\nLegend:");
+    for (size_t r = 0; r < nranges; r++) {
+        printf(" %c=%s (bits %u-%u)", ranges[r].tag, ranges[r].name, ranges[r].lo,
+               ranges[r].lo + ranges[r].bits - 1);
+    }
+    printf(" .=unused\n");
+}
+
+static int by_offset(const void *a, const void *b) {
+    const struct FieldDesc *fa = *(const struct FieldDesc *const *)a;
+    const struct FieldDesc *fb = *(const struct FieldDesc *const *)b;
+    return (fa->offset > fb->offset) - (fa->offset < fb->offset);
+}
+
+static int by_align_desc(const void *a, const void *b) {
+    const struct FieldDesc *fa = *(const struct FieldDesc *const *)a;
+    const struct FieldDesc *fb = *(const struct FieldDesc *const *)b;
+    return (fa->align < fb->align) - (fa->align > fb->align);
+}
+
+void padding_report(const char *title, size_t sz, size_t align, const struct FieldDesc *fields,
+                    size_t nfields) {
+    const struct FieldDesc *order[64];
+    struct FieldDesc units[64];
+    const struct FieldDesc *fam = find_fam(fields, nfields);
+    size_t n = 0, nunits = 0, depth = 0, cursor = 0, end, padding = 0, sorted_size = 0;
+
+    for (size_t f = 0; f < nfields && n < sizeof order / sizeof order[0]; f++) {
+        if (fields[f].kind == FD_MEMBER && !fields[f].fam) order[n++] = &fields[f];
+    }
+
+    // Top-level members and anonymous groups are the units a reorder can
+    // move; a group spans its members and keeps its internal layout.
+    for (size_t f = 0; f < nfields && nunits < sizeof units / sizeof units[0]; f++) {
+        if (fields[f].kind == FD_END) {
+            if (depth > 0) depth--;
+            continue;
+        }
+        if (fields[f].fam) continue;
+        if (depth == 0) {
+            units[nunits] = fields[f];
+            if (fields[f].kind != FD_MEMBER) {
+                units[nunits].offset = (size_t)-1;
+                units[nunits].size = 0;
+                units[nunits].align = 1;
+            }
+            nunits++;
+        } else if (fields[f].kind == FD_MEMBER) {
+            // Nested group markers carry no offset or size of their own.
+            struct FieldDesc *g = &units[nunits - 1];
+            size_t g_end = g->offset == (size_t)-1 ? 0 : g->offset + g->size;
+            if (fields[f].offset < g->offset) g->offset = fields[f].offset;
+            if (fields[f].offset + fields[f].size > g_end) g_end = fields[f].offset + fields[f].size;
+            if (fields[f].align > g->align) g->align = fields[f].align;
+            g->size = (g_end - g->offset + g->align - 1) / g->align * g->align;
+        }
+        if (fields[f].kind != FD_MEMBER) depth++;
+    }
+    qsort(order, n, sizeof order[0], by_offset);
+
+    printf("\n%s padding: size=%zu align=%zu\n", title, sz, align);
+    for (size_t i = 0; i < n; i++) {
+        if (order[i]->offset > cursor) {
+            printf("  %2zu bytes before ", order[i]->offset - cursor);
+            print_field_name(order[i]);
+            printf(" (align %zu)\n", order[i]->align);
+            padding += order[i]->offset - cursor;
+        }
+        if (order[i]->offset + order[i]->size > cursor) cursor = order[i]->offset + order[i]->size;
+    }
+    end = fam && fam->offset > cursor ? fam->offset : cursor;
+    if (end > cursor) {
+        printf("  %2zu bytes before %s[]\n", end - cursor, fam->name);
+        padding += end - cursor;
+    }
+    if (sz > end) {
+        printf("  %2zu bytes tail padding\n", sz - end);
+        padding += sz - end;
+    }
+
+    for (size_t u = 0; u < nunits; u++) order[u] = &units[u];
+    qsort(order, nunits, sizeof order[0], by_align_desc);
+    for (size_t u = 0; u < nunits; u++) {
+        sorted_size = (sorted_size + order[u]->align - 1) / order[u]->align * order[u]->align;
+        sorted_size += order[u]->size;
+    }
+    sorted_size = (sorted_size + align - 1) / align * align;
+    printf("  total padding %zu/%zu bytes; sorted by alignment: %zu bytes\n", padding, sz,
+           sorted_size);
+
+    n = 0;
+    for (size_t f = 0; f < nfields && n < sizeof order / sizeof order[0]; f++) {
+        if (fields[f].kind == FD_MEMBER) order[n++] = &fields[f];
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (order[i]->align > alignof(max_align_t)) {
+            printf("  !! ");
+            print_field_name(order[i]);
+            printf(" is over-aligned (%zu > alignof(max_align_t)=%zu): heap copies need "
+                   "aligned_alloc()\n", order[i]->align, alignof(max_align_t));
+        } else if (order[i]->align > sizeof(void *) && order[i]->align == align) {
+            printf("  !  ");
+            print_field_name(order[i]);
+            printf(" raises struct alignment to %zu\n", order[i]->align);
+        }
+    }
+}
+
+size_t layout_member_mask(size_t sz, const struct FieldDesc *fields, size_t nfields,
+                          unsigned char *mask) {
+    size_t members = 0;
+    memset(mask, 0, sz);
+    for (size_t f = 0; f < nfields; f++) {
+        if (fields[f].kind != FD_MEMBER || fields[f].fam) continue;
+        for (size_t i = 0; i < fields[f].size && fields[f].offset + i < sz; i++) {
+            mask[fields[f].offset + i] = 1;
+        }
+    }
+    for (size_t i = 0; i < sz; i++) members += mask[i];
+    return members;
+}
+
+void fam_alloc_report(const char *title, size_t sz, size_t align, const struct FieldDesc *fields,
+                      size_t nfields, const size_t *counts, size_t ncounts) {
+    const struct FieldDesc *fam = find_fam(fields, nfields);
+    unsigned char mask[256];
+    size_t header_bytes;
+    if (!fam) return;
+    if (fam->offset > sizeof mask) {
+        printf("%s: header too large to size (%zu bytes)\n", title, fam->offset);
+        return;
+    }
+    // Bytes in front of the array that some member covers; overlapping
+    // union alternatives count once.
+    header_bytes = layout_member_mask(fam->offset, fields, nfields, mask);
+
+    printf("\n%s allocation sizing (offsetof(%s)=%zu, sizeof=%zu, elem=%zu, header padding=%zu):\n",
+           title, fam->name, fam->offset, sz, fam->elem_size, fam->offset - header_bytes);
+    printf("%6s %8s %9s %8s %10s %10s\n", "N", "sizeof", "offsetof", "packed", "pad/msg",
+           "MB/1M msg");
+    for (size_t c = 0; c < ncounts; c++) {
+        size_t n = counts[c];
+        size_t payload = header_bytes + n * fam->elem_size;
+        size_t by_sizeof = sz + n * fam->elem_size;
+        size_t by_offsetof = fam->offset + n * fam->elem_size;
+        size_t packed = (by_offsetof + align - 1) / align * align;
+        // Padding per message when records are packed back to back, and what
+        // that padding costs at a million messages.
+        printf("%6zu %8zu %9zu %8zu %10zu %10.2f\n", n, by_sizeof, by_offsetof, packed,
+               packed - payload, (double)(packed - payload) * 1e6 / (1024.0 * 1024.0));
+    }
+}
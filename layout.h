@@ -0,0 +1,127 @@
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include <stddef.h>
+
+enum FieldKind {
+    FD_MEMBER,
+    FD_STRUCT,  // opens an anonymous struct group
+    FD_UNION,   // opens an anonymous union group; each child is an alternative
+    FD_END,     // closes the innermost group
+};
+
+struct FieldDesc {
+    const char *name;
+    char tag;
+    size_t offset;
+    size_t size;       // total bytes; 0 for a flexible array member
+    size_t elem_size;  // bytes per array element; equals size for scalars
+    size_t inner;      // elements per row of a 2-D array, 0 otherwise
+    size_t align;
+    int fam;           // storage lives past the fixed header
+    enum FieldKind kind;
+};
+
+#define FIELD(struct_t, field, tagchar) \
+    (struct FieldDesc){.name = #field, .tag = tagchar, .offset = offsetof(struct_t, field), \
+                       .size = sizeof(((struct_t*)0)->field), \
+                       .elem_size = sizeof(((struct_t*)0)->field), \
+                       .align = __alignof__(((struct_t*)0)->field)}
+
+// Fixed array (`T field[N]`), rendered with element boundaries.
+#define ARRAY_FIELD(struct_t, field, tagchar) \
+    (struct FieldDesc){.name = #field, .tag = tagchar, .offset = offsetof(struct_t, field), \
+                       .size = sizeof(((struct_t*)0)->field), \
+                       .elem_size = sizeof(((struct_t*)0)->field[0]), \
+                       .align = __alignof__(((struct_t*)0)->field)}
+
+// Two-dimensional array (`T field[R][C]`); boundaries are drawn per scalar.
+#define ARRAY2D_FIELD(struct_t, field, tagchar) \
+    (struct FieldDesc){.name = #field, .tag = tagchar, .offset = offsetof(struct_t, field), \
+                       .size = sizeof(((struct_t*)0)->field), \
+                       .elem_size = sizeof(((struct_t*)0)->field[0][0]), \
+                       .inner = sizeof(((struct_t*)0)->field[0]) / \
+                                sizeof(((struct_t*)0)->field[0][0]), \
+                       .align = __alignof__(((struct_t*)0)->field)}
+
+// Flexible array member (`T field[];`). sizeof() is not allowed on an
+// incomplete array, so the element size is taken from field[0].
+#define FAM_FIELD(struct_t, field, tagchar) \
+    (struct FieldDesc){.name = #field, .tag = tagchar, .offset = offsetof(struct_t, field), \
+                       .elem_size = sizeof(((struct_t*)0)->field[0]), \
+                       .align = __alignof__(((struct_t*)0)->field[0]), .fam = 1}
+
+// Members of anonymous structs and unions are addressed directly by name in
+// C11, so FIELD() already gets their flattened offsets right. These markers
+// only record the nesting, e.g.
+//   ANON_UNION, FIELD(T, addr, 'A'), ARRAY_FIELD(T, octets, 'O'), ANON_END,
+#define ANON_STRUCT (struct FieldDesc){.name = "struct", .kind = FD_STRUCT}
+#define ANON_UNION  (struct FieldDesc){.name = "union", .kind = FD_UNION}
+#define ANON_END    (struct FieldDesc){.name = "", .kind = FD_END}
+
+#define NFIELDS(arr) (sizeof(arr)/sizeof((arr)[0]))
+
+// One column of a column-wise (SoA) container.
+struct ColumnDesc {
+    const char *name;
+    char tag;
+    size_t elem_size;
+    const void *data;
+};
+
+// A run of bits inside one word, e.g. a tag stored in a pointer's spare bits.
+struct BitRange {
+    const char *name;
+    char tag;
+    unsigned lo;    // lowest bit
+    unsigned bits;  // width
+};
+
+// Overlapping union alternatives are drawn on extra rows below the first.
+void visualize(const char *title, size_t sz, const struct FieldDesc *fields, size_t nfields);
+
+// Like visualize(), but renders the fixed header followed by `ntrailing`
+// elements of the struct's flexible array member.
+void visualize_var(const char *title, size_t sz, const struct FieldDesc *fields, size_t nfields,
+                   size_t ntrailing);
+
+// visualize() plus a row shading each member by its reads + writes (indexed
+// like `fields`, e.g. accesses per second) and a table of the numbers.
+void visualize_heat(const char *title, size_t sz, const struct FieldDesc *fields, size_t nfields,
+                    const double *reads, const double *writes);
+
+// Prints each column allocation of a SoA container (address alignment,
+// bytes, records per cache line) and draws the cache line holding the start
+// of each column with alternating-case element tags; '.' marks bytes of that
+// line outside the column.
+void visualize_columns(const char *title, const struct ColumnDesc *cols, size_t ncols,
+                       size_t count, size_t capacity);
+
+// Draws a `width`-bit word bit by bit, most significant byte first, with each
+// bit tagged by the range that owns it and '.' for unused bits.
+void visualize_bits(const char *title, unsigned width, const struct BitRange *ranges,
+                    size_t nranges);
+
+// Lists every padding gap, the total, and the size the same members would
+// need when sorted by descending alignment. Members aligned beyond
+// alignof(max_align_t) are called out: malloc() does not honour them and
+// they force padding around every neighbour.
+void padding_report(const char *title, size_t sz, size_t align, const struct FieldDesc *fields,
+                    size_t nfields);
+
+// Sets mask[i] to 1 for every byte of a sz-byte struct covered by a member
+// and 0 for padding. Returns the number of member bytes.
+size_t layout_member_mask(size_t sz, const struct FieldDesc *fields, size_t nfields,
+                          unsigned char *mask);
+
+// Prints the allocation size for typical element counts under the usual
+// sizing rules for a struct with a flexible array member, plus the padding
+// each message carries when records are packed back to back:
+//   sizeof:  sizeof(T) + n*elem        (common, over-allocates tail padding)
+//   offsetof: offsetof(T, fam) + n*elem (exact)
+//   packed:  offsetof sizing rounded up to alignof(T), the stride needed to
+//            place records back to back in a message buffer
+void fam_alloc_report(const char *title, size_t sz, size_t align, const struct FieldDesc *fields,
+                      size_t nfields, const size_t *counts, size_t ncounts);
+
+#endif
@@ -0,0 +1,479 @@
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "commands.h"
+#include "human.h"
+#include "loader.h"
+
+#define MAX_DEPTH 64
+
+const char *load_method_name(enum LoadMethod method) {
+    switch (method) {
+    case LOAD_URING: return "io_uring";
+    case LOAD_PREAD: return "pread";
+    case LOAD_READ:  return "read";
+    case LOAD_MMAP:  return "mmap";
+    }
+    return "?";
+}
+
+// O_DIRECT where the filesystem supports it, buffered otherwise.
+static int open_direct(const char *path, int *direct) {
+    int fd = open(path, O_RDONLY | O_DIRECT);
+    *direct = fd >= 0;
+    if (fd < 0) fd = open(path, O_RDONLY);
+    return fd;
+}
+
+// Reads exactly len bytes at off unless EOF comes first.
+static ssize_t pread_full(int fd, void *buf, size_t len, off_t off) {
+    size_t done = 0;
+    while (done < len) {
+        ssize_t r = pread(fd, (char *)buf + done, len - done, off + (off_t)done);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (r == 0) break;
+        done += (size_t)r;
+    }
+    return (ssize_t)done;
+}
+
+static int load_pread(int fd, uint64_t size, size_t chunk, load_chunk_fn fn, void *ctx) {
+    void *buf = aligned_alloc(LOAD_ALIGN, chunk);
+    int status = 0;
+    if (!buf) return -1;
+    for (uint64_t off = 0; off < size && status == 0; off += chunk) {
+        ssize_t r = pread_full(fd, buf, chunk, (off_t)off);
+        if (r <= 0) {
+            status = -1;
+            break;
+        }
+        status = fn(buf, (size_t)r, off, ctx) ? -1 : 0;
+    }
+    free(buf);
+    return status;
+}
+
+static int load_read(int fd, size_t chunk, load_chunk_fn fn, void *ctx) {
+    void *buf = aligned_alloc(LOAD_ALIGN, chunk);
+    uint64_t off = 0;
+    int status = 0;
+    if (!buf) return -1;
+    for (;;) {
+        ssize_t r = read(fd, buf, chunk);
+        if (r < 0 && errno == EINTR) continue;
+        if (r < 0) status = -1;
+        if (r <= 0) break;
+        if (fn(buf, (size_t)r, off, ctx)) {
+            status = -1;
+            break;
+        }
+        off += (uint64_t)r;
+    }
+    free(buf);
+    return status;
+}
+
+static int load_mmap(int fd, uint64_t size, size_t chunk, load_chunk_fn fn, void *ctx) {
+    const char *map;
+    int status = 0;
+    if (size == 0) return 0;
+    map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) return -1;
+    for (uint64_t off = 0; off < size && status == 0; off += chunk) {
+        size_t len = size - off < chunk ? (size_t)(size - off) : chunk;
+        status = fn(map + off, len, off, ctx) ? -1 : 0;
+    }
+    munmap((void *)map, size);
+    return status;
+}
+
+// Minimal io_uring driver on the raw system calls.
+struct Uring {
+    int fd;
+    unsigned sq_entries, cq_entries;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_map, *cq_map;
+    size_t sq_map_len, cq_map_len, sqes_len;
+};
+
+static int uring_init(struct Uring *u, unsigned entries) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof p);
+    memset(u, 0, sizeof *u);
+    u->fd = (int)syscall(__NR_io_uring_setup, entries, &p);
+    if (u->fd < 0) return -1;
+
+    u->sq_map_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    u->cq_map_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (u->cq_map_len > u->sq_map_len) u->sq_map_len = u->cq_map_len;
+        u->cq_map_len = 0;
+    }
+    u->sq_map = mmap(NULL, u->sq_map_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     u->fd, IORING_OFF_SQ_RING);
+    if (u->sq_map == MAP_FAILED) goto fail;
+    u->cq_map = u->sq_map;
+    if (u->cq_map_len) {
+        u->cq_map = mmap(NULL, u->cq_map_len, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, u->fd, IORING_OFF_CQ_RING);
+        if (u->cq_map == MAP_FAILED) goto fail;
+    }
+    u->sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+    u->sqes = mmap(NULL, u->sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, u->fd,
+                   IORING_OFF_SQES);
+    if (u->sqes == MAP_FAILED) goto fail;
+
+    u->sq_entries = p.sq_entries;
+    u->cq_entries = p.cq_entries;
+    u->sq_head = (unsigned *)((char *)u->sq_map + p.sq_off.head);
+    u->sq_tail = (unsigned *)((char *)u->sq_map + p.sq_off.tail);
+    u->sq_mask = (unsigned *)((char *)u->sq_map + p.sq_off.ring_mask);
+    u->sq_array = (unsigned *)((char *)u->sq_map + p.sq_off.array);
+    u->cq_head = (unsigned *)((char *)u->cq_map + p.cq_off.head);
+    u->cq_tail = (unsigned *)((char *)u->cq_map + p.cq_off.tail);
+    u->cq_mask = (unsigned *)((char *)u->cq_map + p.cq_off.ring_mask);
+    u->cqes = (struct io_uring_cqe *)((char *)u->cq_map + p.cq_off.cqes);
+    return 0;
+
+fail:
+    if (u->sq_map && u->sq_map != MAP_FAILED) munmap(u->sq_map, u->sq_map_len);
+    if (u->cq_map_len && u->cq_map && u->cq_map != MAP_FAILED) munmap(u->cq_map, u->cq_map_len);
+    close(u->fd);
+    return -1;
+}
+
+static void uring_exit(struct Uring *u) {
+    munmap(u->sqes, u->sqes_len);
+    if (u->cq_map_len) munmap(u->cq_map, u->cq_map_len);
+    munmap(u->sq_map, u->sq_map_len);
+    close(u->fd);
+}
+
+static void uring_queue_read(struct Uring *u, int fd, void *buf, unsigned len, uint64_t off,
+                             unsigned buf_index) {
+    unsigned tail = *u->sq_tail, idx = tail & *u->sq_mask;
+    struct io_uring_sqe *sqe = &u->sqes[idx];
+    memset(sqe, 0, sizeof *sqe);
+    sqe->opcode = IORING_OP_READ_FIXED;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)buf;
+    sqe->len = len;
+    sqe->off = off;
+    sqe->buf_index = (uint16_t)buf_index;
+    sqe->user_data = buf_index;
+    u->sq_array[idx] = idx;
+    __atomic_store_n(u->sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+static int uring_submit_and_wait(struct Uring *u, unsigned submit, unsigned wait) {
+    for (;;) {
+        long r = syscall(__NR_io_uring_enter, u->fd, submit, wait,
+                         wait ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+        if (r >= 0 || errno != EINTR) return r < 0 ? -1 : 0;
+    }
+}
+
+static int load_uring(int fd, uint64_t size, size_t chunk, unsigned depth, load_chunk_fn fn,
+                      void *ctx) {
+    struct Uring u;
+    struct iovec iov[MAX_DEPTH];
+    int32_t result[MAX_DEPTH];
+    uint64_t slot_off[MAX_DEPTH];
+    unsigned char inflight[MAX_DEPTH] = {0};
+    unsigned char *pool = NULL;
+    uint64_t next_off = 0, deliver_off = 0;
+    unsigned queued = 0, head = 0;
+    int status = -1;
+
+    if (depth == 0) depth = 1;
+    if (depth > MAX_DEPTH) depth = MAX_DEPTH;
+    if (uring_init(&u, depth) != 0) return -2;
+    pool = aligned_alloc(LOAD_ALIGN, chunk * depth);
+    if (!pool) goto out;
+    for (unsigned s = 0; s < depth; s++) {
+        iov[s].iov_base = pool + s * chunk;
+        iov[s].iov_len = chunk;
+        result[s] = INT32_MIN;
+    }
+    if (syscall(__NR_io_uring_register, u.fd, IORING_REGISTER_BUFFERS, iov, depth) != 0) {
+        status = -2;
+        goto out;
+    }
+
+    // Slots are filled round-robin, so slot `head` always holds the next
+    // chunk in file order; later completions wait until it is delivered.
+    for (unsigned s = 0; s < depth && next_off < size; s++, queued++) {
+        slot_off[s] = next_off;
+        uring_queue_read(&u, fd, iov[s].iov_base, (unsigned)chunk, next_off, s);
+        inflight[s] = 1;
+        next_off += chunk;
+    }
+    if (uring_submit_and_wait(&u, queued, 0) != 0) goto out;
+
+    while (deliver_off < size) {
+        unsigned submit = 0;
+        if (result[head] == INT32_MIN) {
+            unsigned cq_head = *u.cq_head;
+            if (cq_head == __atomic_load_n(u.cq_tail, __ATOMIC_ACQUIRE)) {
+                if (uring_submit_and_wait(&u, 0, 1) != 0) goto out;
+                continue;
+            }
+            for (; cq_head != __atomic_load_n(u.cq_tail, __ATOMIC_ACQUIRE); cq_head++) {
+                struct io_uring_cqe *cqe = &u.cqes[cq_head & *u.cq_mask];
+                result[cqe->user_data] = cqe->res;
+                inflight[cqe->user_data] = 0;
+            }
+            __atomic_store_n(u.cq_head, cq_head, __ATOMIC_RELEASE);
+            continue;
+        }
+
+        {
+            size_t got = result[head] < 0 ? 0 : (size_t)result[head];
+            size_t want = size - slot_off[head] < chunk ? (size_t)(size - slot_off[head]) : chunk;
+            if (result[head] < 0) goto out;
+            // A short read before EOF is completed synchronously.
+            if (got < want) {
+                ssize_t r = pread_full(fd, (char *)iov[head].iov_base + got, want - got,
+                                       (off_t)(slot_off[head] + got));
+                if (r < 0 || (size_t)r != want - got) goto out;
+                got = want;
+            }
+            if (fn(iov[head].iov_base, got, slot_off[head], ctx)) goto out;
+            deliver_off += got;
+        }
+        result[head] = INT32_MIN;
+        if (next_off < size) {
+            slot_off[head] = next_off;
+            uring_queue_read(&u, fd, iov[head].iov_base, (unsigned)chunk, next_off, head);
+            inflight[head] = 1;
+            next_off += chunk;
+            submit = 1;
+        }
+        head = (head + 1) % depth;
+        if (submit && uring_submit_and_wait(&u, 1, 0) != 0) goto out;
+    }
+    status = 0;
+
+out:
+    // Drain reads still in flight before their buffers are freed.
+    for (;;) {
+        unsigned busy = 0, cq_head = *u.cq_head;
+        for (unsigned k = 0; k < depth; k++) busy += inflight[k];
+        if (!busy) break;
+        if (cq_head == __atomic_load_n(u.cq_tail, __ATOMIC_ACQUIRE)) {
+            if (uring_submit_and_wait(&u, 0, 1) != 0) break;
+            continue;
+        }
+        for (; cq_head != __atomic_load_n(u.cq_tail, __ATOMIC_ACQUIRE); cq_head++) {
+            inflight[u.cqes[cq_head & *u.cq_mask].user_data] = 0;
+        }
+        __atomic_store_n(u.cq_head, cq_head, __ATOMIC_RELEASE);
+    }
+    uring_exit(&u);
+    free(pool);
+    return status;
+}
+
+int load_file(const char *path, enum LoadMethod method, size_t chunk_size, unsigned depth,
+              load_chunk_fn fn, void *ctx, struct LoadStats *stats) {
+    struct stat st;
+    int fd, direct = 0, status;
+    size_t chunk = (chunk_size + LOAD_ALIGN - 1) / LOAD_ALIGN * LOAD_ALIGN;
+
+    if (chunk == 0) chunk = LOAD_ALIGN;
+    fd = method == LOAD_URING || method == LOAD_PREAD ? open_direct(path, &direct)
+                                                      : open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    stats->used = method;
+    switch (method) {
+    case LOAD_URING:
+        status = load_uring(fd, (uint64_t)st.st_size, chunk, depth, fn, ctx);
+        if (status == -2) {
+            // io_uring unavailable (old kernel, seccomp): same reads via pread.
+            stats->used = LOAD_PREAD;
+            status = load_pread(fd, (uint64_t)st.st_size, chunk, fn, ctx);
+        }
+        break;
+    case LOAD_PREAD:
+        status = load_pread(fd, (uint64_t)st.st_size, chunk, fn, ctx);
+        break;
+    case LOAD_READ:
+        status = load_read(fd, chunk, fn, ctx);
+        break;
+    case LOAD_MMAP:
+    default:
+        status = load_mmap(fd, (uint64_t)st.st_size, chunk, fn, ctx);
+        break;
+    }
+    stats->bytes = (uint64_t)st.st_size;
+    stats->direct = direct;
+    close(fd);
+    return status;
+}
+
+static inline void fold_record(struct RecordScan *s, const unsigned char *rec) {
+    uint64_t v = 0;
+    memcpy(&v, rec + s->field->offset, s->field->size < sizeof v ? s->field->size : sizeof v);
+    s->checksum += v;
+    s->records++;
+}
+
+int record_scan_chunk(const void *data, size_t len, uint64_t offset, void *ctx) {
+    struct RecordScan *s = ctx;
+    const unsigned char *p = data, *end = p + len;
+    (void)offset;
+
+    // A straddling record must fit in the carry buffer.
+    if (s->record_size == 0 || s->record_size > sizeof s->carry) return -1;
+    if (s->carry_len) {
+        size_t need = s->record_size - s->carry_len;
+        if (need > len) need = len;
+        memcpy(s->carry + s->carry_len, p, need);
+        s->carry_len += need;
+        p += need;
+        if (s->carry_len < s->record_size) return 0;
+        fold_record(s, s->carry);
+        s->carry_len = 0;
+    }
+    for (; (size_t)(end - p) >= s->record_size; p += s->record_size) fold_record(s, p);
+    memcpy(s->carry, p, (size_t)(end - p));
+    s->carry_len = (size_t)(end - p);
+    return 0;
+}
+
+int write_record_file(const char *path, const void *records, size_t bytes) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    size_t done = 0;
+    if (fd < 0) return -1;
+    while (done < bytes) {
+        ssize_t w = write(fd, (const char *)records + done, bytes - done);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) {
+            close(fd);
+            return -1;
+        }
+        done += (size_t)w;
+    }
+    fsync(fd);
+    close(fd);
+    return 0;
+}
+
+void evict_file(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+// Benchmark: write a record file per layout, then scan it with each method
+// after evicting it from the page cache (cold) and again right after (warm).
+int bench_loader(int argc, char **argv) {
+    size_t n = arg_count(argc, argv, 1, 4000000);
+    const char *dir = argc > 2 ? argv[2] : ".";
+    human1_t *src = malloc(n * sizeof *src);
+    human_worst_t *worst = malloc(n * sizeof *worst);
+    human_slim_t *slim = malloc(n * sizeof *slim);
+    struct FieldDesc worst_age = FIELD(human_worst_t, age, 'A');
+    struct FieldDesc human1_age = FIELD(human1_t, age, 'A');
+    struct FieldDesc slim_age = FIELD(human_slim_t, age, 'A');
+    struct {
+        const char *name;
+        const void *data;
+        size_t size;
+        const struct FieldDesc *field;
+    } files[3];
+    static const enum LoadMethod methods[] = {LOAD_URING, LOAD_PREAD, LOAD_READ, LOAD_MMAP};
+    char path[4096];
+    int status = 1;
+
+    if (!src || !worst || !slim) {
+        fprintf(stderr, "bench-loader: cannot allocate %zu records\n", n);
+        goto out;
+    }
+    human_fill(src, n, 17);
+    human_to_worst(worst, src, n);
+    human_to_slim(slim, src, n);
+    files[0].name = "worst";
+    files[0].data = worst;
+    files[0].size = sizeof *worst;
+    files[0].field = &worst_age;
+    files[1].name = "human1";
+    files[1].data = src;
+    files[1].size = sizeof *src;
+    files[1].field = &human1_age;
+    files[2].name = "slim";
+    files[2].data = slim;
+    files[2].size = sizeof *slim;
+    files[2].field = &slim_age;
+
+    printf("Record file scan, %zu records, 1 MiB chunks, io_uring depth 8:\n", n);
+    printf("%-8s %6s %9s %-10s %6s %10s %10s %11s\n", "layout", "bytes", "MiB", "method",
+           "direct", "cold MB/s", "warm MB/s", "cold Mrec/s");
+    for (size_t f = 0; f < 3; f++) {
+        snprintf(path, sizeof path, "%s/records_%s.bin", dir, files[f].name);
+        if (write_record_file(path, files[f].data, n * files[f].size) != 0) {
+            fprintf(stderr, "bench-loader: cannot write %s: %s\n", path, strerror(errno));
+            goto out;
+        }
+        for (size_t m = 0; m < sizeof methods / sizeof methods[0]; m++) {
+            double mbps[2];
+            struct LoadStats stats = {0, methods[m], 0};
+            for (int warm = 0; warm <= 1; warm++) {
+                struct RecordScan scan;
+                uint64_t t0, dt;
+                memset(&scan, 0, sizeof scan);
+                scan.record_size = files[f].size;
+                scan.field = files[f].field;
+                if (!warm) evict_file(path);
+                t0 = now_ns();
+                if (load_file(path, methods[m], 1 << 20, 8, record_scan_chunk, &scan,
+                              &stats) != 0 || scan.records != n) {
+                    fprintf(stderr, "bench-loader: %s load of %s failed\n",
+                            load_method_name(methods[m]), path);
+                    unlink(path);
+                    goto out;
+                }
+                dt = now_ns() - t0;
+                bench_sink += scan.checksum;
+                mbps[warm] = (double)stats.bytes / ((double)dt / 1e9) / 1e6;
+            }
+            printf("%-8s %6zu %9.1f %-10s %6s %10.1f %10.1f %11.1f\n", files[f].name,
+                   files[f].size, (double)(n * files[f].size) / (1024.0 * 1024.0),
+                   load_method_name(stats.used), stats.direct ? "yes" : "no", mbps[0], mbps[1],
+                   mbps[0] / (double)files[f].size);
+        }
+        unlink(path);
+    }
+    status = 0;
+
+out:
+    free(src);
+    free(worst);
+    free(slim);
+    return status;
+}
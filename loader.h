@@ -0,0 +1,61 @@
+#ifndef LOADER_H
+#define LOADER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "layout.h"
+
+// Bulk loader for binary record files. Every method delivers the file as a
+// sequence of chunks in file order; chunk buffers are aligned to
+// LOAD_ALIGN and only valid during the callback.
+//
+//   LOAD_URING  io_uring READ_FIXED into registered buffers, `depth` reads
+//               in flight, O_DIRECT when the filesystem allows it
+//   LOAD_PREAD  pread() into one aligned buffer, O_DIRECT when allowed
+//   LOAD_READ   buffered read() into one reusable buffer
+//   LOAD_MMAP   mmap() of the whole file, delivered chunk by chunk
+
+#define LOAD_ALIGN 4096
+
+enum LoadMethod { LOAD_URING, LOAD_PREAD, LOAD_READ, LOAD_MMAP };
+
+// Returning non-zero stops the load.
+typedef int (*load_chunk_fn)(const void *data, size_t len, uint64_t offset, void *ctx);
+
+struct LoadStats {
+    uint64_t bytes;
+    enum LoadMethod used;  // LOAD_URING falls back to LOAD_PREAD
+    int direct;            // O_DIRECT was in effect
+};
+
+// chunk_size is rounded up to LOAD_ALIGN. Returns 0 on success, -1 on an
+// I/O error or when the callback stopped the load.
+int load_file(const char *path, enum LoadMethod method, size_t chunk_size, unsigned depth,
+              load_chunk_fn fn, void *ctx, struct LoadStats *stats);
+
+const char *load_method_name(enum LoadMethod method);
+
+// Writes and fsyncs a record file. Returns 0 on success, -1 on error.
+int  write_record_file(const char *path, const void *records, size_t bytes);
+// Drops the file's clean pages from the page cache.
+void evict_file(const char *path);
+
+// Chunk consumer that reassembles records straddling chunk boundaries and
+// folds one described field of every record into a checksum. Records of
+// 1 to RECORD_SCAN_MAX bytes are supported; any other record_size makes
+// record_scan_chunk() return -1, which stops load_file().
+#define RECORD_SCAN_MAX 256
+
+struct RecordScan {
+    size_t record_size;
+    const struct FieldDesc *field;
+    uint64_t records;
+    uint64_t checksum;
+    size_t carry_len;
+    unsigned char carry[RECORD_SCAN_MAX];
+};
+
+int record_scan_chunk(const void *data, size_t len, uint64_t offset, void *ctx);
+
+#endif
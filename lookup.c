@@ -0,0 +1,210 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "commands.h"
+#include "human.h"
+#include "layout.h"
+
+// Batched random lookups: hash the first name of records picked by index.
+// With human1_t that is two dependent cache misses (record, then the string
+// name.first points to), so a plain loop waits on memory twice per lookup.
+// The interleaved versions keep `group` lookups in flight as small state
+// machines (a hand-rolled equivalent of coroutines): each step issues a
+// prefetch for the next address a lookup needs and moves on to the next
+// lookup, so the misses of different lookups overlap.
+
+#define MAX_GROUP 64
+#define NAME_LEN  16
+
+typedef struct HumanInline {
+    char   first_initial;
+    int    age;
+    double height;
+    char   first[NAME_LEN];
+    char   last[NAME_LEN];
+} human_inline_t;
+
+static inline uint64_t hash_name(const char *s) {
+    uint64_t h = 1469598103934665603u;
+    for (; *s; s++) h = (h ^ (unsigned char)*s) * 1099511628211u;
+    return h;
+}
+
+static uint64_t lookup_pointer_seq(const human1_t *rows, const uint32_t *idx, size_t n) {
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) acc += hash_name(rows[idx[i]].name.first);
+    return acc;
+}
+
+static uint64_t lookup_inline_seq(const human_inline_t *rows, const uint32_t *idx, size_t n) {
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) acc += hash_name(rows[idx[i]].first);
+    return acc;
+}
+
+enum LookupStage { STAGE_START, STAGE_RECORD, STAGE_NAME };
+
+struct LookupState {
+    enum LookupStage stage;
+    size_t next;           // position in idx of this lookup
+    const human1_t *row;
+    const char *name;
+};
+
+static uint64_t lookup_pointer_interleaved(const human1_t *rows, const uint32_t *idx, size_t n,
+                                           unsigned group) {
+    struct LookupState st[MAX_GROUP];
+    size_t issued = 0, done = 0;
+    uint64_t acc = 0;
+
+    for (unsigned g = 0; g < group; g++) st[g].stage = STAGE_START;
+    while (done < n) {
+        for (unsigned g = 0; g < group; g++) {
+            struct LookupState *s = &st[g];
+            switch (s->stage) {
+            case STAGE_START:
+                if (issued == n) break;
+                s->next = issued++;
+                s->row = &rows[idx[s->next]];
+                __builtin_prefetch(s->row);
+                s->stage = STAGE_RECORD;
+                break;
+            case STAGE_RECORD:
+                s->name = s->row->name.first;
+                __builtin_prefetch(s->name);
+                s->stage = STAGE_NAME;
+                break;
+            case STAGE_NAME:
+                acc += hash_name(s->name);
+                done++;
+                s->stage = STAGE_START;
+                break;
+            }
+        }
+    }
+    return acc;
+}
+
+static uint64_t lookup_inline_interleaved(const human_inline_t *rows, const uint32_t *idx,
+                                          size_t n, unsigned group) {
+    const human_inline_t *pending[MAX_GROUP];
+    size_t issued = 0;
+    uint64_t acc = 0;
+
+    // One miss per lookup: prefetch `group` records ahead.
+    for (; issued < group && issued < n; issued++) {
+        pending[issued] = &rows[idx[issued]];
+        __builtin_prefetch(pending[issued]);
+    }
+    for (size_t i = 0; i < n; i++) {
+        const human_inline_t *r = pending[i % group];
+        if (issued < n) {
+            pending[i % group] = &rows[idx[issued++]];
+            __builtin_prefetch(pending[i % group]);
+        }
+        acc += hash_name(r->first);
+    }
+    return acc;
+}
+
+int bench_lookup(int argc, char **argv) {
+    size_t n = arg_count(argc, argv, 1, 8000000);
+    size_t nlookups = n;
+    human1_t *rows = malloc(n * sizeof *rows);
+    human_inline_t *inl = malloc(n * sizeof *inl);
+    char *arena = malloc(n * NAME_LEN);
+    uint32_t *idx = malloc(nlookups * sizeof *idx);
+    uint32_t *slot = malloc(n * sizeof *slot);
+    static const unsigned groups[] = {1, 4, 8, 16, 32};
+    struct FieldDesc inline_fields[] = {
+        FIELD(human_inline_t,       first_initial, 'F'),
+        FIELD(human_inline_t,       age,           'A'),
+        FIELD(human_inline_t,       height,        'H'),
+        ARRAY_FIELD(human_inline_t, first,         'N'),
+        ARRAY_FIELD(human_inline_t, last,          'L'),
+    };
+    uint64_t expect, acc, t0, dt;
+    uint64_t state = 88172645463325252u;
+    int status = 1;
+
+    if (!rows || !inl || !arena || !idx || !slot) {
+        fprintf(stderr, "bench-lookup: cannot allocate %zu records\n", n);
+        goto out;
+    }
+    human_fill(rows, n, 3);
+
+    // Give every record its own copy of its first name, at a shuffled arena
+    // slot, so following name.first is a cache miss like on a real heap.
+    for (size_t i = 0; i < n; i++) slot[i] = (uint32_t)i;
+    for (size_t i = n - 1; i > 0; i--) {
+        size_t j;
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        j = state % (i + 1);
+        uint32_t t = slot[i];
+        slot[i] = slot[j];
+        slot[j] = t;
+    }
+    for (size_t i = 0; i < n; i++) {
+        char *copy = arena + (size_t)slot[i] * NAME_LEN;
+        inl[i].first_initial = rows[i].first_initial;
+        inl[i].age = rows[i].age;
+        inl[i].height = rows[i].height;
+        snprintf(copy, NAME_LEN, "%s", rows[i].name.first);
+        snprintf(inl[i].first, NAME_LEN, "%s", rows[i].name.first);
+        snprintf(inl[i].last, NAME_LEN, "%s", rows[i].name.last);
+        rows[i].name.first = copy;
+    }
+    for (size_t i = 0; i < nlookups; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        idx[i] = (uint32_t)(state % n);
+    }
+
+    visualize("HumanInline", sizeof(human_inline_t), inline_fields, NFIELDS(inline_fields));
+
+    expect = lookup_pointer_seq(rows, idx, nlookups);
+    printf("\n%zu random lookups over %zu records (ns/lookup):\n", nlookups, n);
+    printf("%-28s %8s %10s\n", "variant", "group", "ns");
+
+    t0 = now_ns();
+    acc = lookup_pointer_seq(rows, idx, nlookups);
+    dt = now_ns() - t0;
+    printf("%-28s %8s %10.1f\n", "human1_t name.first, loop", "-", (double)dt / (double)nlookups);
+    for (size_t g = 0; g < sizeof groups / sizeof groups[0]; g++) {
+        t0 = now_ns();
+        acc = lookup_pointer_interleaved(rows, idx, nlookups, groups[g]);
+        dt = now_ns() - t0;
+        printf("%-28s %8u %10.1f%s\n", "human1_t name.first, AMAC", groups[g],
+               (double)dt / (double)nlookups, acc == expect ? "" : "  MISMATCH");
+    }
+
+    t0 = now_ns();
+    acc = lookup_inline_seq(inl, idx, nlookups);
+    dt = now_ns() - t0;
+    printf("%-28s %8s %10.1f%s\n", "inline name, loop", "-", (double)dt / (double)nlookups,
+           acc == expect ? "" : "  MISMATCH");
+    for (size_t g = 0; g < sizeof groups / sizeof groups[0]; g++) {
+        t0 = now_ns();
+        acc = lookup_inline_interleaved(inl, idx, nlookups, groups[g]);
+        dt = now_ns() - t0;
+        printf("%-28s %8u %10.1f%s\n", "inline name, prefetch", groups[g],
+               (double)dt / (double)nlookups, acc == expect ? "" : "  MISMATCH");
+    }
+    bench_sink += acc;
+    status = 0;
+
+out:
+    free(rows);
+    free(inl);
+    free(arena);
+    free(idx);
+    free(slot);
+    return status;
+}
@@ -0,0 +1,119 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "lz.h"
+
+#define LZ_MIN_MATCH  4
+#define LZ_HASH_BITS  14
+#define LZ_MAX_OFFSET 65535
+// Matches stop this far from the end so the last bytes are always literals.
+#define LZ_TAIL       12
+
+size_t lz_bound(size_t n) {
+    return n + n / 255 + 16;
+}
+
+static inline uint32_t read32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof v);
+    return v;
+}
+
+static inline uint32_t hash4(uint32_t v) {
+    return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+static uint8_t *put_length(uint8_t *op, size_t len) {
+    for (; len >= 255; len -= 255) *op++ = 255;
+    *op++ = (uint8_t)len;
+    return op;
+}
+
+static uint8_t *put_sequence(uint8_t *op, const uint8_t *lit, size_t nlit, size_t match,
+                             size_t offset) {
+    uint8_t *token = op++;
+    *token = (uint8_t)((nlit < 15 ? nlit : 15) << 4);
+    if (nlit >= 15) op = put_length(op, nlit - 15);
+    memcpy(op, lit, nlit);
+    op += nlit;
+    if (match) {
+        size_t m = match - LZ_MIN_MATCH;
+        *op++ = (uint8_t)(offset & 0xff);
+        *op++ = (uint8_t)(offset >> 8);
+        *token |= (uint8_t)(m < 15 ? m : 15);
+        if (m >= 15) op = put_length(op, m - 15);
+    }
+    return op;
+}
+
+size_t lz_compress(const uint8_t *src, size_t n, uint8_t *dst, size_t cap) {
+    uint32_t *table;
+    const uint8_t *ip = src, *anchor = src, *end = src + n;
+    const uint8_t *limit = n > LZ_TAIL ? end - LZ_TAIL : src;
+    uint8_t *op = dst;
+
+    if (cap < lz_bound(n)) return 0;
+    table = calloc((size_t)1 << LZ_HASH_BITS, sizeof *table);
+    if (!table) return 0;
+
+    while (ip < limit) {
+        uint32_t h = hash4(read32(ip));
+        const uint8_t *ref = src + table[h];
+        table[h] = (uint32_t)(ip - src);
+        if (ref < ip && (size_t)(ip - ref) <= LZ_MAX_OFFSET && read32(ref) == read32(ip)) {
+            const uint8_t *mp = ip + LZ_MIN_MATCH, *rp = ref + LZ_MIN_MATCH;
+            while (mp < limit && *mp == *rp) {
+                mp++;
+                rp++;
+            }
+            op = put_sequence(op, anchor, (size_t)(ip - anchor), (size_t)(mp - ip),
+                              (size_t)(ip - ref));
+            ip = anchor = mp;
+            continue;
+        }
+        ip++;
+    }
+    op = put_sequence(op, anchor, (size_t)(end - anchor), 0, 0);
+    free(table);
+    return (size_t)(op - dst);
+}
+
+static int get_length(const uint8_t **ip, const uint8_t *end, size_t *len) {
+    uint8_t b;
+    do {
+        if (*ip >= end) return -1;
+        b = *(*ip)++;
+        *len += b;
+    } while (b == 255);
+    return 0;
+}
+
+size_t lz_decompress(const uint8_t *src, size_t n, uint8_t *dst, size_t cap) {
+    const uint8_t *ip = src, *end = src + n;
+    uint8_t *op = dst, *oend = dst + cap;
+
+    while (ip < end) {
+        uint8_t token = *ip++;
+        size_t nlit = token >> 4, match, offset;
+
+        if (nlit == 15 && get_length(&ip, end, &nlit) != 0) return (size_t)-1;
+        if ((size_t)(end - ip) < nlit || (size_t)(oend - op) < nlit) return (size_t)-1;
+        memcpy(op, ip, nlit);
+        ip += nlit;
+        op += nlit;
+        if (ip == end) break;  // final literal-only sequence
+
+        if (end - ip < 2) return (size_t)-1;
+        offset = (size_t)ip[0] | (size_t)ip[1] << 8;
+        ip += 2;
+        match = token & 15;
+        if (match == 15 && get_length(&ip, end, &match) != 0) return (size_t)-1;
+        match += LZ_MIN_MATCH;
+        if (offset == 0 || offset > (size_t)(op - dst) || (size_t)(oend - op) < match) {
+            return (size_t)-1;
+        }
+        // Byte copy: overlapping matches (offset < length) repeat a pattern.
+        for (const uint8_t *ref = op - offset; match > 0; match--) *op++ = *ref++;
+    }
+    return (size_t)(op - dst);
+}
@@ -0,0 +1,21 @@
+#ifndef LZ_H
+#define LZ_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Small LZ77 codec in the LZ4 style: a sequence is a token (literal count
+// in the high nibble, match length - 4 in the low nibble, 15 meaning "more
+// length bytes follow"), the literals, and a 16-bit little-endian match
+// offset. The final sequence carries literals only. Single pass, one hash
+// table probe per position; built for speed rather than ratio.
+
+// Worst-case compressed size for n input bytes.
+size_t lz_bound(size_t n);
+// Returns the compressed size, or 0 if dst is smaller than lz_bound(n).
+size_t lz_compress(const uint8_t *src, size_t n, uint8_t *dst, size_t cap);
+// Returns the decompressed size, or (size_t)-1 on malformed input or when
+// the output would exceed cap.
+size_t lz_decompress(const uint8_t *src, size_t n, uint8_t *dst, size_t cap);
+
+#endif
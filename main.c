@@ -3,72 +3,285 @@
 #include <stddef.h>
 #include <stdalign.h>
 #include <string.h>
+#include <stdint.h>
 
-typedef struct Name {
-    char* first;
-    char* last;
-} name_t;
+#include "commands.h"
+#include "human.h"
+#include "layout.h"
 
-typedef struct Human1 {
-    char   first_initial;
-    int    age;
-    double height;
-    name_t name;
-} human1_t;
+// Variable-length records: a fixed header followed by a flexible array member.
+typedef struct NameRecord {
+    uint32_t id;
+    uint16_t len;
+    char     initial;
+    char     text[];
+} name_record_t;
 
-typedef struct Human2 {
-    name_t name;
-    double height;
+typedef struct HeightSeries {
     int    age;
-    char   first_initial;
-} human2_t;
+    char   initial;
+    double heights[];
+} height_series_t;
 
-struct FieldDesc {
-    const char *name;
-    char tag;
-    size_t offset;
-    size_t size;
-};
+typedef struct HumanBatch {
+    uint16_t count;
+    human1_t people[];
+} human_batch_t;
 
-#define FIELD(struct_t, field, tagchar) \
-    (struct FieldDesc){#field, tagchar, offsetof(struct_t, field), sizeof(((struct_t*)0)->field)}
+// Fixed arrays and wide scalars.
+typedef struct Record {
+    char  code[13];
+    int   id;
+    float matrix[3][4];
+    char  flag;
+} record_t;
 
-static void visualize(const char *title, size_t sz, const struct FieldDesc *fields, size_t nfields) {
-    char mem[256] = {0};
-    if (sz > sizeof mem) {
-        printf("%s: struct too large to visualize (%zu bytes)\n", title, sz);
-        return;
-    }
+typedef float v8sf __attribute__((vector_size(32)));
 
-    for (size_t i = 0; i < sz; i++) mem[i] = 'P';
+typedef struct Particle {
+    char  kind;
+    float pos[8];
+    int   id;
+} particle_t;
 
-    for (size_t f = 0; f < nfields; f++) {
-        for (size_t i = 0; i < fields[f].size; i++) {
-            mem[fields[f].offset + i] = fields[f].tag;
-        }
-    }
+// Same members, but pos is a 32-byte vector (an __m256 on x86).
+typedef struct SimdParticle {
+    char kind;
+    v8sf pos;
+    int  id;
+} simd_particle_t;
+
+__extension__ typedef __int128 int128_t;
+
+typedef struct Wide {
+    char        tag;
+    int128_t    big;
+    char        kind;
+    long double ld;
+#ifdef __FLT16_MAX__
+    __extension__ _Float16 half;
+#else
+    short half;
+#endif
+} wide_t;
+
+static void show_wide_types(void) {
+    struct FieldDesc record_fields[] = {
+        ARRAY_FIELD(record_t,   code,   'C'),
+        FIELD(record_t,         id,     'I'),
+        ARRAY2D_FIELD(record_t, matrix, 'M'),
+        FIELD(record_t,         flag,   'G'),
+    };
+    struct FieldDesc particle_fields[] = {
+        FIELD(particle_t,       kind, 'K'),
+        ARRAY_FIELD(particle_t, pos,  'V'),
+        FIELD(particle_t,       id,   'I'),
+    };
+    struct FieldDesc simd_particle_fields[] = {
+        FIELD(simd_particle_t, kind, 'K'),
+        FIELD(simd_particle_t, pos,  'V'),
+        FIELD(simd_particle_t, id,   'I'),
+    };
+    struct FieldDesc wide_fields[] = {
+        FIELD(wide_t, tag,  'T'),
+        FIELD(wide_t, big,  'B'),
+        FIELD(wide_t, kind, 'K'),
+        FIELD(wide_t, ld,   'L'),
+        FIELD(wide_t, half, 'H'),
+    };
+
+    printf("\nArrays and wide scalars:\n");
+    visualize("Record", sizeof(record_t), record_fields, NFIELDS(record_fields));
+    padding_report("Record", sizeof(record_t), alignof(record_t), record_fields,
+                   NFIELDS(record_fields));
+
+    visualize("Particle (float[8])", sizeof(particle_t), particle_fields, NFIELDS(particle_fields));
+    padding_report("Particle", sizeof(particle_t), alignof(particle_t), particle_fields,
+                   NFIELDS(particle_fields));
+
+    visualize("SimdParticle (v8sf)", sizeof(simd_particle_t), simd_particle_fields,
+              NFIELDS(simd_particle_fields));
+    // GCC's _Alignof reports the 16-byte ABI minimum for 32-byte vectors when
+    // AVX is off, but layout uses the 32-byte __alignof__ value.
+    padding_report("SimdParticle", sizeof(simd_particle_t), __alignof__(simd_particle_t),
+                   simd_particle_fields, NFIELDS(simd_particle_fields));
+
+    visualize("Wide", sizeof(wide_t), wide_fields, NFIELDS(wide_fields));
+    padding_report("Wide", sizeof(wide_t), alignof(wide_t), wide_fields, NFIELDS(wide_fields));
 
-    printf("\n%s: size=%zu bytes\n", title, sz);
-    printf("Offsets: ");
-    for (size_t f = 0; f < nfields; f++) {
-        printf("%s@%zu ", fields[f].name, fields[f].offset);
-    }
     printf("\n");
+    printf("alignof(int128_t)    = %zu\n", alignof(int128_t));
+    printf("alignof(long double) = %zu (sizeof %zu)\n", alignof(long double), sizeof(long double));
+    printf("alignof(v8sf)        = %zu (__alignof__ %zu)\n", alignof(v8sf), __alignof__(v8sf));
+    printf("alignof(max_align_t) = %zu\n", alignof(max_align_t));
+}
+
+// Anonymous members: zero-cost aliasing in packet and state types.
+typedef struct PacketHeader {
+    uint8_t kind;
+    union {
+        uint32_t addr;
+        uint8_t  octets[4];
+        struct {
+            uint16_t lo;
+            uint16_t hi;
+        };
+    };
+    uint16_t len;
+} packet_header_t;
+
+// A reading that is either a value or a count with its unit.
+typedef struct Sample {
+    uint8_t kind;
+    union {
+        double value;
+        struct {
+            uint32_t count;
+            uint16_t unit;
+        };
+    };
+    uint8_t flags;
+} sample_t;
+
+typedef struct Human3 {
+    struct {
+        char first_initial;
+        int  age;
+    };
+    union {
+        double  height;
+        int64_t height_um;
+    };
+    name_t name;
+} human3_t;
+
+static void show_anonymous_members(void) {
+    struct FieldDesc packet_header_fields[] = {
+        FIELD(packet_header_t, kind, 'K'),
+        ANON_UNION,
+            FIELD(packet_header_t,       addr,   'A'),
+            ARRAY_FIELD(packet_header_t, octets, 'O'),
+            ANON_STRUCT,
+                FIELD(packet_header_t, lo, 'L'),
+                FIELD(packet_header_t, hi, 'H'),
+            ANON_END,
+        ANON_END,
+        FIELD(packet_header_t, len, 'N'),
+    };
+    struct FieldDesc sample_fields[] = {
+        FIELD(sample_t, kind, 'K'),
+        ANON_UNION,
+            FIELD(sample_t, value, 'V'),
+            ANON_STRUCT,
+                FIELD(sample_t, count, 'C'),
+                FIELD(sample_t, unit,  'U'),
+            ANON_END,
+        ANON_END,
+        FIELD(sample_t, flags, 'F'),
+    };
+    struct FieldDesc human3_fields[] = {
+        ANON_STRUCT,
+            FIELD(human3_t, first_initial, 'F'),
+            FIELD(human3_t, age,           'A'),
+        ANON_END,
+        ANON_UNION,
+            FIELD(human3_t, height,    'H'),
+            FIELD(human3_t, height_um, 'U'),
+        ANON_END,
+        FIELD(human3_t, name, 'N'),
+    };
+
+    printf("\nAnonymous structs and unions:\n");
+    visualize("PacketHeader", sizeof(packet_header_t), packet_header_fields,
+              NFIELDS(packet_header_fields));
+    padding_report("PacketHeader", sizeof(packet_header_t), alignof(packet_header_t),
+                   packet_header_fields, NFIELDS(packet_header_fields));
+    visualize("Sample", sizeof(sample_t), sample_fields, NFIELDS(sample_fields));
+    padding_report("Sample", sizeof(sample_t), alignof(sample_t), sample_fields,
+                   NFIELDS(sample_fields));
+    visualize("Human3", sizeof(human3_t), human3_fields, NFIELDS(human3_fields));
+    padding_report("Human3", sizeof(human3_t), alignof(human3_t), human3_fields,
+                   NFIELDS(human3_fields));
+}
+
+static void show_variable_records(void) {
+    static const size_t counts[] = {0, 1, 3, 8, 13, 64};
+    struct FieldDesc name_record_fields[] = {
+        FIELD(name_record_t,     id,      'I'),
+        FIELD(name_record_t,     len,     'L'),
+        FIELD(name_record_t,     initial, 'F'),
+        FAM_FIELD(name_record_t, text,    'T'),
+    };
+    struct FieldDesc height_series_fields[] = {
+        FIELD(height_series_t,     age,     'A'),
+        FIELD(height_series_t,     initial, 'F'),
+        FAM_FIELD(height_series_t, heights, 'H'),
+    };
+    struct FieldDesc human_batch_fields[] = {
+        FIELD(human_batch_t,     count,  'C'),
+        FAM_FIELD(human_batch_t, people, 'X'),
+    };
 
-    for (size_t i = 0; i < sz; i++) {
-        printf("%2zu |", i);
+    printf("\nVariable-length records:\n");
+    visualize_var("NameRecord \"Ada\"", sizeof(name_record_t), name_record_fields,
+                  NFIELDS(name_record_fields), 3);
+    visualize_var("HeightSeries x3", sizeof(height_series_t), height_series_fields,
+                  NFIELDS(height_series_fields), 3);
+
+    fam_alloc_report("NameRecord", sizeof(name_record_t), alignof(name_record_t),
+                     name_record_fields, NFIELDS(name_record_fields),
+                     counts, NFIELDS(counts));
+    fam_alloc_report("HeightSeries", sizeof(height_series_t), alignof(height_series_t),
+                     height_series_fields, NFIELDS(height_series_fields),
+                     counts, NFIELDS(counts));
+    fam_alloc_report("HumanBatch", sizeof(human_batch_t), alignof(human_batch_t),
+                     human_batch_fields, NFIELDS(human_batch_fields),
+                     counts, NFIELDS(counts));
+}
+
+struct Command {
+    const char *name;
+    int (*run)(int argc, char **argv);
+    const char *help;
+};
+
+static const struct Command commands[] = {
+    {"bench-atomic", bench_atomic, "[iters]  load/store/CAS cost of _Atomic structs"},
+    {"bench-query",  bench_query,  "[rows]   filter pipeline throughput, AoS vs SoA"},
+    {"bench-agg",    bench_agg,    "[rows]   GROUP BY hash aggregation per state layout"},
+    {"bench-bitpack", bench_bitpack, "[rows]  age scan over int, uint8 and bit-packed columns"},
+    {"bench-encoding", bench_encoding, "[rows] dictionary, FOR and delta encoded columns"},
+    {"bench-parscan", bench_parscan, "[rows [threads]] work-stealing scan scaling per layout"},
+    {"bench-lookup", bench_lookup, "[rows]   interleaved random lookups, pointer vs inline names"},
+    {"bench-csv",    bench_csv,    "[rows [threads]] CSV ingestion into each layout"},
+    {"bench-loader", bench_loader, "[rows [dir]] record file scan: io_uring, pread, read, mmap"},
+    {"bench-pagecache", bench_pagecache, "[rows [dir]] faults and page cache residency per layout"},
+    {"padding-files", padding_files, "[rows [dir]] raw/zeroed/stripped record files, LZ ratios"},
+    {"bench-slotted", bench_slotted, "[rows]  slotted pages vs human1_t[] with heap names"},
+    {"bench-wire", bench_wire, "[rows]  struct, packed and offset-table wire formats"},
+    {"bench-cow", bench_cow, "[rows]  COW faults and dirtied pages of age updates after fork()"},
+    {"vec-report", vec_report, "[rows [dir]] vectorization remarks, instruction mix, timings per layout"},
+    {"sample-fields", sample_fields, "[pid addr count layout [s]] watchpoint field access heat"},
+    {"bench-soavec", bench_soavec, "[rows]  soa_vector.h against a growable human1_t array"},
+    {"bench-packed", bench_packed, "[rows]  PACKED_RECORD layouts against declaration order"},
+    {"bench-optional", bench_optional, "[rows]  presence-flag against niche-encoded optional fields"},
+    {"bench-tagged", bench_tagged, "[rows]  small fields in spare pointer bits against human2_t"},
+};
+
+static int run_command(int argc, char **argv) {
+    for (size_t c = 0; c < NFIELDS(commands); c++) {
+        if (strcmp(argv[0], commands[c].name) == 0) return commands[c].run(argc, argv);
     }
-    printf("\n");
-    for (size_t i = 0; i < sz; i++) {
-        printf(" %c |", mem[i]);
+    fprintf(stderr, "usage: memory_padding [command [args...]]\n\ncommands:\n");
+    for (size_t c = 0; c < NFIELDS(commands); c++) {
+        fprintf(stderr, "  %-16s %s\n", commands[c].name, commands[c].help);
     }
-    printf("\n");
-    printf("\nLegend: ");
-    for (size_t f = 0; f < nfields; f++) printf("%c=%s ", fields[f].tag, fields[f].name);
-    printf("P=padding\n");
+    return strcmp(argv[0], "help") == 0 ? 0 : 1;
 }
 
-int main(void) {
+int main(int argc, char **argv) {
+    if (argc > 1) return run_command(argc - 1, argv + 1);
+
     struct FieldDesc human1_fields[] = {
         FIELD(human1_t, first_initial, 'F'),
         FIELD(human1_t, age,           'A'),
@@ -82,8 +295,10 @@ int main(void) {
         FIELD(human2_t, first_initial, 'F'),
     };
 
-    visualize("Human1", sizeof(human1_t), human1_fields, sizeof(human1_fields)/sizeof(human1_fields[0]));
-    visualize("Human2", sizeof(human2_t), human2_fields, sizeof(human2_fields)/sizeof(human2_fields[0]));
+    visualize("Human1", sizeof(human1_t), human1_fields, NFIELDS(human1_fields));
+    visualize("Human2", sizeof(human2_t), human2_fields, NFIELDS(human2_fields));
+    padding_report("Human1", sizeof(human1_t), alignof(human1_t), human1_fields, NFIELDS(human1_fields));
+    padding_report("Human2", sizeof(human2_t), alignof(human2_t), human2_fields, NFIELDS(human2_fields));
 
     // Quick compare summary
     printf("\nComparison:\n");
@@ -111,5 +326,10 @@ int main(void) {
     printf("alignof(int)     = %zu\n", alignof(int));
     printf("alignof(char)    = %zu\n", alignof(char));
 
+    show_variable_records();
+    show_wide_types();
+    show_atomic_layouts();
+    show_anonymous_members();
+
     return 0;
 }
@@ -0,0 +1,191 @@
+#ifndef NICHE_OPTIONAL_H
+#define NICHE_OPTIONAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Optional values. OPTIONAL_DEFINE stores a presence flag next to the value,
+// which usually costs a whole alignment unit of padding. The niche variants
+// store nothing extra: "none" is a bit pattern the value never takes.
+//
+//   OPTIONAL_DEFINE(name, T)                         { T value; bool present; }
+//   OPTIONAL_NULL_DEFINE(name, T, path)              none: value path == NULL
+//   OPTIONAL_SENTINEL_DEFINE(name, T, path, value)   none: value path == value
+//   OPTIONAL_NAN_DEFINE(name, T, path)               none: value path is OPT_NAN_NICHE
+//
+// `path` selects the member holding the niche (`.first` for name_t) and is
+// empty when T itself is the pointer, index or double. Each macro defines
+// opt_NAME_t and
+//   opt_NAME_none()       empty optional
+//   opt_NAME_some(v)      optional holding v
+//   opt_NAME_has(&o)      whether o holds a value
+//   opt_NAME_get(&o)      the value; only meaningful if has()
+// some(v) with v in the niche (a null first name, the sentinel index) reads
+// back as none, so only niches the data cannot produce are usable. A
+// _Static_assert checks that the member at `path` has the kind its niche
+// needs: a data pointer, an integer or enum, or a double.
+
+// Two-alternative variants (either an A or a B) work the same way:
+//
+//   VARIANT_DEFINE(name, A, B)                 { bool is_b; union { A a; B b; }; }
+//   VARIANT_NICHE_DEFINE(name, A, member, B)   is_b: a.member == NULL
+//
+// In the niche form `member` is a pointer member of A at offset 0 that is
+// never null in an A; a B is stored behind a null pointer in that slot, so
+// the variant is sizeof(A) as long as a pointer plus a B fit in an A. Both
+// define var_NAME_t and
+//   var_NAME_a(v), var_NAME_b(v)             variant holding an A or a B
+//   var_NAME_is_b(&x)                        which alternative x holds
+//   var_NAME_get_a(&x), var_NAME_get_b(&x)   the alternative it holds
+
+// A quiet NaN with a payload that arithmetic never produces: operations on
+// NaNs return the canonical 0x7ff8000000000000 or propagate an input payload.
+#define OPT_NAN_NICHE 0x7ff84e4943484521ull
+
+static inline void opt_nan_store_(double *d) {
+    uint64_t bits = OPT_NAN_NICHE;
+    memcpy(d, &bits, sizeof bits);
+}
+
+static inline bool opt_nan_is_niche_(double d) {
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof bits);
+    return bits == OPT_NAN_NICHE;
+}
+
+#define OPT_GET_(name, T)                                                      \
+    static inline T opt_##name##_get(const opt_##name##_t *o) {                \
+        return o->value;                                                       \
+    }
+
+#define OPTIONAL_DEFINE(name, T)                                               \
+    typedef struct {                                                           \
+        T    value;                                                            \
+        bool present;                                                          \
+    } opt_##name##_t;                                                          \
+    static inline opt_##name##_t opt_##name##_none(void) {                     \
+        opt_##name##_t o;                                                      \
+        memset(&o, 0, sizeof o);                                               \
+        return o;                                                              \
+    }                                                                          \
+    static inline opt_##name##_t opt_##name##_some(T v) {                      \
+        opt_##name##_t o;                                                      \
+        memset(&o, 0, sizeof o);                                               \
+        o.value = v;                                                           \
+        o.present = true;                                                      \
+        return o;                                                              \
+    }                                                                          \
+    static inline bool opt_##name##_has(const opt_##name##_t *o) {             \
+        return o->present;                                                     \
+    }                                                                          \
+    OPT_GET_(name, T)
+
+// SET_NONE stores the niche into o->value, HAS tests o->value for it.
+#define OPT_NICHE_(name, T, SET_NONE, HAS)                                     \
+    typedef struct {                                                           \
+        T value;                                                               \
+    } opt_##name##_t;                                                          \
+    static inline opt_##name##_t opt_##name##_none(void) {                     \
+        opt_##name##_t none, *o = &none;                                       \
+        memset(o, 0, sizeof none);                                             \
+        SET_NONE;                                                              \
+        return none;                                                           \
+    }                                                                          \
+    static inline opt_##name##_t opt_##name##_some(T v) {                      \
+        opt_##name##_t o;                                                      \
+        o.value = v;                                                           \
+        return o;                                                              \
+    }                                                                          \
+    static inline bool opt_##name##_has(const opt_##name##_t *o) {             \
+        return HAS;                                                            \
+    }                                                                          \
+    OPT_GET_(name, T)
+
+// The niche member, unevaluated, for the type checks below.
+#define OPT_MEMBER_(T, path) ((*(T *)0) path)
+
+#define OPT_IS_INTEGER_(x)                                                       \
+    _Generic((x), char: 1, signed char: 1, unsigned char: 1, short: 1,           \
+             unsigned short: 1, int: 1, unsigned: 1, long: 1, unsigned long: 1,  \
+             long long: 1, unsigned long long: 1, default: 0)
+
+// &* only compiles for a pointer operand.
+#define OPTIONAL_NULL_DEFINE(name, T, path)                                      \
+    OPT_NICHE_(name, T, o->value path = NULL, o->value path != NULL)             \
+    _Static_assert(sizeof(&*OPT_MEMBER_(T, path)) == sizeof(void *),             \
+                   "niche of " #name " is not a data pointer");
+
+#define OPTIONAL_SENTINEL_DEFINE(name, T, path, sentinel)                        \
+    OPT_NICHE_(name, T, o->value path = (sentinel), o->value path != (sentinel)) \
+    _Static_assert(OPT_IS_INTEGER_(OPT_MEMBER_(T, path)),                        \
+                   "niche of " #name " is not an integer or enum");
+
+#define OPTIONAL_NAN_DEFINE(name, T, path)                                       \
+    OPT_NICHE_(name, T, opt_nan_store_(&o->value path),                          \
+               !opt_nan_is_niche_(o->value path))                                \
+    _Static_assert(_Generic(OPT_MEMBER_(T, path), double: 1, default: 0),        \
+                   "niche of " #name " is not a double");
+
+#define VAR_COMMON_(name, A, B, IS_B, GET_A, GET_B)                              \
+    static inline bool var_##name##_is_b(const var_##name##_t *x) {              \
+        return IS_B;                                                             \
+    }                                                                            \
+    static inline A var_##name##_get_a(const var_##name##_t *x) {                \
+        return GET_A;                                                            \
+    }                                                                            \
+    static inline B var_##name##_get_b(const var_##name##_t *x) {                \
+        return GET_B;                                                            \
+    }
+
+#define VARIANT_DEFINE(name, A, B)                                               \
+    typedef struct {                                                             \
+        bool is_b;                                                               \
+        union {                                                                  \
+            A a;                                                                 \
+            B b;                                                                 \
+        } u;                                                                     \
+    } var_##name##_t;                                                            \
+    static inline var_##name##_t var_##name##_a(A v) {                           \
+        var_##name##_t x;                                                        \
+        memset(&x, 0, sizeof x);                                                 \
+        x.u.a = v;                                                               \
+        return x;                                                                \
+    }                                                                            \
+    static inline var_##name##_t var_##name##_b(B v) {                           \
+        var_##name##_t x;                                                        \
+        memset(&x, 0, sizeof x);                                                 \
+        x.is_b = true;                                                           \
+        x.u.b = v;                                                               \
+        return x;                                                                \
+    }                                                                            \
+    VAR_COMMON_(name, A, B, x->is_b, x->u.a, x->u.b)
+
+#define VARIANT_NICHE_DEFINE(name, A, member, B)                                 \
+    typedef union {                                                              \
+        A a;                                                                     \
+        struct {                                                                 \
+            void *niche;  /* overlays a.member; NULL for a B */                  \
+            B     b;                                                             \
+        } alt;                                                                   \
+    } var_##name##_t;                                                            \
+    _Static_assert(offsetof(A, member) == 0, #member " is not at offset 0");     \
+    _Static_assert(sizeof(&*((A *)0)->member) == sizeof(void *),                 \
+                   #member " is not a data pointer");                            \
+    _Static_assert(sizeof(var_##name##_t) == sizeof(A),                          \
+                   #B " does not fit in " #A);                                   \
+    static inline var_##name##_t var_##name##_a(A v) {                           \
+        var_##name##_t x;                                                        \
+        x.a = v;                                                                 \
+        return x;                                                                \
+    }                                                                            \
+    static inline var_##name##_t var_##name##_b(B v) {                           \
+        var_##name##_t x;                                                        \
+        memset(&x, 0, sizeof x);                                                 \
+        x.alt.b = v;                                                             \
+        return x;                                                                \
+    }                                                                            \
+    VAR_COMMON_(name, A, B, x->a.member == NULL, x->a, x->alt.b)
+
+#endif
@@ -0,0 +1,262 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdalign.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "commands.h"
+#include "human.h"
+#include "layout.h"
+#include "niche_optional.h"
+
+// A record of four optional fields, once with presence flags and once with
+// niches: a null first name, a NaN payload in the height, an out-of-range
+// manager index and an unused enum value. The flag version pays a flag and
+// its padding per field; the niche version is the size of the values. The
+// same goes for a variant holding either a name or an id into a name table:
+// a null name.first marks the id, so no tag byte is needed.
+
+enum Status { STATUS_ACTIVE, STATUS_RETIRED, STATUS_ON_LEAVE, STATUS_COUNT };
+
+OPTIONAL_DEFINE(name_flag, name_t)
+OPTIONAL_DEFINE(height_flag, double)
+OPTIONAL_DEFINE(manager_flag, uint32_t)
+OPTIONAL_DEFINE(status_flag, enum Status)
+
+OPTIONAL_NULL_DEFINE(name, name_t, .first)
+OPTIONAL_NAN_DEFINE(height, double, )
+OPTIONAL_SENTINEL_DEFINE(manager, uint32_t, , UINT32_MAX)
+OPTIONAL_SENTINEL_DEFINE(status, enum Status, , STATUS_COUNT)
+
+VARIANT_DEFINE(name_ref_tag, name_t, uint32_t)
+VARIANT_NICHE_DEFINE(name_ref, name_t, first, uint32_t)
+
+typedef struct EmployeeFlag {
+    opt_name_flag_t    name;
+    opt_height_flag_t  height;
+    opt_manager_flag_t manager;
+    opt_status_flag_t  status;
+} employee_flag_t;
+
+typedef struct EmployeeNiche {
+    opt_name_t    name;
+    opt_height_t  height;
+    opt_manager_t manager;
+    opt_status_t  status;
+} employee_niche_t;
+
+static uint64_t scan_flag(const employee_flag_t *e, size_t n) {
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) {
+        acc += (uint64_t)opt_name_flag_has(&e[i].name) +
+               (opt_height_flag_has(&e[i].height)
+                    ? (uint64_t)(opt_height_flag_get(&e[i].height) * 100.0) : 0) +
+               (opt_manager_flag_has(&e[i].manager) ? opt_manager_flag_get(&e[i].manager) : 0) +
+               (opt_status_flag_has(&e[i].status)
+                    ? (uint64_t)opt_status_flag_get(&e[i].status) : 0);
+    }
+    return acc;
+}
+
+static uint64_t scan_niche(const employee_niche_t *e, size_t n) {
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) {
+        acc += (uint64_t)opt_name_has(&e[i].name) +
+               (opt_height_has(&e[i].height) ? (uint64_t)(opt_height_get(&e[i].height) * 100.0)
+                                             : 0) +
+               (opt_manager_has(&e[i].manager) ? opt_manager_get(&e[i].manager) : 0) +
+               (opt_status_has(&e[i].status) ? (uint64_t)opt_status_get(&e[i].status) : 0);
+    }
+    return acc;
+}
+
+static uint64_t scan_ref_tag(const var_name_ref_tag_t *v, size_t n) {
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) {
+        acc += var_name_ref_tag_is_b(&v[i]) ? var_name_ref_tag_get_b(&v[i])
+                                            : (unsigned char)var_name_ref_tag_get_a(&v[i]).first[0];
+    }
+    return acc;
+}
+
+static uint64_t scan_ref_niche(const var_name_ref_t *v, size_t n) {
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) {
+        acc += var_name_ref_is_b(&v[i]) ? var_name_ref_get_b(&v[i])
+                                        : (unsigned char)var_name_ref_get_a(&v[i]).first[0];
+    }
+    return acc;
+}
+
+// Every 4th reference is an id rather than an inline name.
+static void build_ref_tag(var_name_ref_tag_t *v, const human1_t *src, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        v[i] = i % 4 ? var_name_ref_tag_a(src[i].name) : var_name_ref_tag_b((uint32_t)(i / 4));
+    }
+}
+
+static void build_ref_niche(var_name_ref_t *v, const human1_t *src, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        v[i] = i % 4 ? var_name_ref_a(src[i].name) : var_name_ref_b((uint32_t)(i / 4));
+    }
+}
+
+// Record i lacks its name every 8th, height every 5th, manager every 3rd and
+// status every 4th record.
+static void build_flag(employee_flag_t *e, const human1_t *src, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        e[i].name = i % 8 ? opt_name_flag_some(src[i].name) : opt_name_flag_none();
+        e[i].height = i % 5 ? opt_height_flag_some(src[i].height) : opt_height_flag_none();
+        e[i].manager = i % 3 ? opt_manager_flag_some((uint32_t)(i / 16)) : opt_manager_flag_none();
+        e[i].status = i % 4 ? opt_status_flag_some((enum Status)(i % 3)) : opt_status_flag_none();
+    }
+}
+
+static void build_niche(employee_niche_t *e, const human1_t *src, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        e[i].name = i % 8 ? opt_name_some(src[i].name) : opt_name_none();
+        e[i].height = i % 5 ? opt_height_some(src[i].height) : opt_height_none();
+        e[i].manager = i % 3 ? opt_manager_some((uint32_t)(i / 16)) : opt_manager_none();
+        e[i].status = i % 4 ? opt_status_some((enum Status)(i % 3)) : opt_status_none();
+    }
+}
+
+int bench_optional(int argc, char **argv) {
+    size_t n = arg_count(argc, argv, 1, 4000000);
+    human1_t *src = malloc(n * sizeof *src);
+    employee_flag_t *flag = malloc(n * sizeof *flag);
+    employee_niche_t *niche = malloc(n * sizeof *niche);
+    var_name_ref_tag_t *ref_tag = malloc(n * sizeof *ref_tag);
+    var_name_ref_t *ref_niche = malloc(n * sizeof *ref_niche);
+    struct FieldDesc flag_fields[] = {
+        FIELD(employee_flag_t, name.value,      'N'),
+        FIELD(employee_flag_t, name.present,    'n'),
+        FIELD(employee_flag_t, height.value,    'H'),
+        FIELD(employee_flag_t, height.present,  'h'),
+        FIELD(employee_flag_t, manager.value,   'M'),
+        FIELD(employee_flag_t, manager.present, 'm'),
+        FIELD(employee_flag_t, status.value,    'S'),
+        FIELD(employee_flag_t, status.present,  's'),
+    };
+    struct FieldDesc niche_fields[] = {
+        FIELD(employee_niche_t, name,    'N'),
+        FIELD(employee_niche_t, height,  'H'),
+        FIELD(employee_niche_t, manager, 'M'),
+        FIELD(employee_niche_t, status,  'S'),
+    };
+    struct FieldDesc ref_tag_fields[] = {
+        FIELD(var_name_ref_tag_t, is_b, 't'),
+        ANON_UNION,
+            FIELD(var_name_ref_tag_t, u.a, 'N'),
+            FIELD(var_name_ref_tag_t, u.b, 'I'),
+        ANON_END,
+    };
+    struct FieldDesc ref_niche_fields[] = {
+        ANON_UNION,
+            FIELD(var_name_ref_t, a, 'N'),
+            ANON_STRUCT,
+                FIELD(var_name_ref_t, alt.niche, 'n'),
+                FIELD(var_name_ref_t, alt.b,     'I'),
+            ANON_END,
+        ANON_END,
+    };
+    static const struct {
+        const char *field, *niche;
+        size_t flag_size, niche_size;
+    } savings[] = {
+        {"name", "first == NULL", sizeof(opt_name_flag_t), sizeof(opt_name_t)},
+        {"height", "NaN payload", sizeof(opt_height_flag_t), sizeof(opt_height_t)},
+        {"manager", "index UINT32_MAX", sizeof(opt_manager_flag_t), sizeof(opt_manager_t)},
+        {"status", "STATUS_COUNT", sizeof(opt_status_flag_t), sizeof(opt_status_t)},
+    };
+    uint64_t t0, build_f, build_n, scan_f, scan_n, a, b;
+    int status = 1;
+
+    visualize("EmployeeFlag (value + presence flag)", sizeof(employee_flag_t), flag_fields,
+              NFIELDS(flag_fields));
+    padding_report("EmployeeFlag", sizeof(employee_flag_t), alignof(employee_flag_t),
+                   flag_fields, NFIELDS(flag_fields));
+    visualize("EmployeeNiche (niche-encoded none)", sizeof(employee_niche_t), niche_fields,
+              NFIELDS(niche_fields));
+
+    printf("\n%-8s %-17s %6s %6s %6s\n", "field", "niche", "flag", "niche", "saved");
+    for (size_t i = 0; i < NFIELDS(savings); i++) {
+        printf("%-8s %-17s %6zu %6zu %6zu\n", savings[i].field, savings[i].niche,
+               savings[i].flag_size, savings[i].niche_size,
+               savings[i].flag_size - savings[i].niche_size);
+    }
+    printf("%-8s %-17s %6zu %6zu %6zu\n", "record", "", sizeof(employee_flag_t),
+           sizeof(employee_niche_t), sizeof(employee_flag_t) - sizeof(employee_niche_t));
+
+    visualize("name|id variant with a tag", sizeof(var_name_ref_tag_t), ref_tag_fields,
+              NFIELDS(ref_tag_fields));
+    visualize("name|id variant, id behind a null first", sizeof(var_name_ref_t),
+              ref_niche_fields, NFIELDS(ref_niche_fields));
+    printf("\nname|id variant: %zu bytes with a tag, %zu with the id behind a null first\n",
+           sizeof(var_name_ref_tag_t), sizeof(var_name_ref_t));
+
+    if (!src || !flag || !niche || !ref_tag || !ref_niche) {
+        fprintf(stderr, "bench-optional: cannot allocate %zu records\n", n);
+        goto out;
+    }
+    human_fill(src, n, 43);
+    // Fault both arrays in first so the build times compare the encodings.
+    memset(flag, 0, n * sizeof *flag);
+    memset(niche, 0, n * sizeof *niche);
+    memset(ref_tag, 0, n * sizeof *ref_tag);
+    memset(ref_niche, 0, n * sizeof *ref_niche);
+
+    t0 = now_ns();
+    build_flag(flag, src, n);
+    build_f = now_ns() - t0;
+    t0 = now_ns();
+    build_niche(niche, src, n);
+    build_n = now_ns() - t0;
+    t0 = now_ns();
+    a = scan_flag(flag, n);
+    scan_f = now_ns() - t0;
+    t0 = now_ns();
+    b = scan_niche(niche, n);
+    scan_n = now_ns() - t0;
+    bench_sink += a + b;
+
+    printf("\n%zu optional records (ns/record):\n", n);
+    printf("%-14s %6s %9s %8s %8s\n", "layout", "bytes", "MiB", "build", "scan");
+    printf("%-14s %6zu %9.1f %8.2f %8.2f\n", "presence flag", sizeof(employee_flag_t),
+           (double)(n * sizeof(employee_flag_t)) / (1024.0 * 1024.0),
+           (double)build_f / (double)n, (double)scan_f / (double)n);
+    printf("%-14s %6zu %9.1f %8.2f %8.2f%s\n", "niche", sizeof(employee_niche_t),
+           (double)(n * sizeof(employee_niche_t)) / (1024.0 * 1024.0),
+           (double)build_n / (double)n, (double)scan_n / (double)n, a == b ? "" : "  MISMATCH");
+
+    t0 = now_ns();
+    build_ref_tag(ref_tag, src, n);
+    build_f = now_ns() - t0;
+    t0 = now_ns();
+    build_ref_niche(ref_niche, src, n);
+    build_n = now_ns() - t0;
+    t0 = now_ns();
+    a = scan_ref_tag(ref_tag, n);
+    scan_f = now_ns() - t0;
+    t0 = now_ns();
+    b = scan_ref_niche(ref_niche, n);
+    scan_n = now_ns() - t0;
+    bench_sink += a + b;
+    printf("%-14s %6zu %9.1f %8.2f %8.2f\n", "variant tag", sizeof(var_name_ref_tag_t),
+           (double)(n * sizeof(var_name_ref_tag_t)) / (1024.0 * 1024.0),
+           (double)build_f / (double)n, (double)scan_f / (double)n);
+    printf("%-14s %6zu %9.1f %8.2f %8.2f%s\n", "variant niche", sizeof(var_name_ref_t),
+           (double)(n * sizeof(var_name_ref_t)) / (1024.0 * 1024.0),
+           (double)build_n / (double)n, (double)scan_n / (double)n, a == b ? "" : "  MISMATCH");
+    status = 0;
+
+out:
+    free(src);
+    free(flag);
+    free(niche);
+    free(ref_tag);
+    free(ref_niche);
+    return status;
+}
@@ -0,0 +1,96 @@
+#ifndef PACKED_RECORD_H
+#define PACKED_RECORD_H
+
+#include <stddef.h>
+
+// Record types laid out by the preprocessor. The member list is an X-macro
+// whose entries carry the member's alignment class (A1, A2, A4, A8, A16):
+//
+//   #define SENSOR_MEMBERS(X) X(A1, char, kind) X(A8, double, value) X(A4, int, id)
+//   DECLARED_RECORD(sensor_decl, SENSOR_MEMBERS)  // members in list order
+//   PACKED_RECORD(sensor, SENSOR_MEMBERS)         // members by descending alignment
+//
+// PACKED_RECORD emits the members of each class in turn, so the struct has
+// no interior padding; _Static_asserts check every class tag against
+// _Alignof(type) and the finished size against the member sizes. Members
+// keep their names, and both macros also define
+//   NAME_nfields                 number of members
+//   NAME_offset(i)               offset of the i-th member in list order
+// so generic code can address members by their position in the list.
+
+#define PR_BYTES_A1  1
+#define PR_BYTES_A2  2
+#define PR_BYTES_A4  4
+#define PR_BYTES_A8  8
+#define PR_BYTES_A16 16
+
+// PR_IF_<class>_<pass>(x) keeps x only when the member's class is the pass.
+#define PR_IF_A1_A1(x)  x
+#define PR_IF_A1_A2(x)
+#define PR_IF_A1_A4(x)
+#define PR_IF_A1_A8(x)
+#define PR_IF_A1_A16(x)
+#define PR_IF_A2_A1(x)
+#define PR_IF_A2_A2(x)  x
+#define PR_IF_A2_A4(x)
+#define PR_IF_A2_A8(x)
+#define PR_IF_A2_A16(x)
+#define PR_IF_A4_A1(x)
+#define PR_IF_A4_A2(x)
+#define PR_IF_A4_A4(x)  x
+#define PR_IF_A4_A8(x)
+#define PR_IF_A4_A16(x)
+#define PR_IF_A8_A1(x)
+#define PR_IF_A8_A2(x)
+#define PR_IF_A8_A4(x)
+#define PR_IF_A8_A8(x)  x
+#define PR_IF_A8_A16(x)
+#define PR_IF_A16_A1(x)
+#define PR_IF_A16_A2(x)
+#define PR_IF_A16_A4(x)
+#define PR_IF_A16_A8(x)
+#define PR_IF_A16_A16(x) x
+
+#define PR_IN_A16_(cls, type, member) PR_IF_##cls##_A16(type member;)
+#define PR_IN_A8_(cls, type, member)  PR_IF_##cls##_A8(type member;)
+#define PR_IN_A4_(cls, type, member)  PR_IF_##cls##_A4(type member;)
+#define PR_IN_A2_(cls, type, member)  PR_IF_##cls##_A2(type member;)
+#define PR_IN_A1_(cls, type, member)  PR_IF_##cls##_A1(type member;)
+#define PR_DECL_(cls, type, member)   type member;
+#define PR_SIZE_(cls, type, member)   + sizeof(type)
+#define PR_ONE_(cls, type, member)    + 1
+#define PR_OFFSET_(cls, type, member) offsetof(pr_self_t, member),
+#define PR_CLASS_(cls, type, member) \
+    _Static_assert(_Alignof(type) == PR_BYTES_##cls, #member " is not of class " #cls);
+
+#define PR_ACCESSORS_(name, MEMBERS)                                   \
+    enum { name##_nfields = 0 MEMBERS(PR_ONE_) };                      \
+    static inline size_t name##_offset(size_t index) {                 \
+        typedef name##_t pr_self_t;                                    \
+        static const size_t offsets[] = {MEMBERS(PR_OFFSET_)};         \
+        return offsets[index];                                         \
+    }
+
+#define DECLARED_RECORD(name, MEMBERS)  \
+    typedef struct {                    \
+        MEMBERS(PR_DECL_)               \
+    } name##_t;                         \
+    PR_ACCESSORS_(name, MEMBERS)
+
+#define PACKED_RECORD(name, MEMBERS)                                                     \
+    typedef struct {                                                                     \
+        MEMBERS(PR_IN_A16_)                                                              \
+        MEMBERS(PR_IN_A8_)                                                               \
+        MEMBERS(PR_IN_A4_)                                                               \
+        MEMBERS(PR_IN_A2_)                                                               \
+        MEMBERS(PR_IN_A1_)                                                               \
+    } name##_t;                                                                          \
+    MEMBERS(PR_CLASS_)                                                                   \
+    _Static_assert(sizeof(name##_t) - (0 MEMBERS(PR_SIZE_)) < _Alignof(name##_t),        \
+                   #name " has interior padding");                                       \
+    PR_ACCESSORS_(name, MEMBERS)
+
+// Address of the i-th member (list order) of *rec.
+#define RECORD_FIELD(name, rec, i) ((void *)((char *)(rec) + name##_offset(i)))
+
+#endif
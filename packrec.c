@@ -0,0 +1,154 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdalign.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "commands.h"
+#include "human.h"
+#include "layout.h"
+#include "packed_record.h"
+
+// Declaration order against preprocessor-sorted order for the same member
+// lists (packed_record.h), and what reaching a member costs in each: by name
+// and by list position through NAME_offset().
+
+#define WORST_MEMBERS(X) \
+    X(A1, char, first_initial) X(A8, double, height) X(A4, int, age) X(A8, name_t, name)
+
+#define SENSOR_MEMBERS(X)                                                      \
+    X(A1, char, kind) X(A8, double, value) X(A1, char, unit) X(A4, int32_t, id) \
+    X(A1, char, flags) X(A8, double, timestamp) X(A2, uint16_t, channel)
+
+DECLARED_RECORD(worst_decl, WORST_MEMBERS)
+PACKED_RECORD(worst_packed, WORST_MEMBERS)
+DECLARED_RECORD(sensor_decl, SENSOR_MEMBERS)
+PACKED_RECORD(sensor_packed, SENSOR_MEMBERS)
+
+// Sorting the human_worst_t members yields human2_t's layout.
+_Static_assert(sizeof(worst_decl_t) == sizeof(human_worst_t), "declared order differs");
+_Static_assert(sizeof(worst_packed_t) == sizeof(human2_t), "packed order is not human2_t-sized");
+
+#define AGE_INDEX 2  // position of age in WORST_MEMBERS
+
+static uint64_t sum_decl_named(const worst_decl_t *r, size_t n) {
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) acc += (uint64_t)r[i].age;
+    return acc;
+}
+
+static uint64_t sum_packed_named(const worst_packed_t *r, size_t n) {
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) acc += (uint64_t)r[i].age;
+    return acc;
+}
+
+// `index` is a run-time value, as in generic code walking the member list.
+static uint64_t sum_packed_indexed(const worst_packed_t *r, size_t n, size_t index) {
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) {
+        acc += (uint64_t)*(const int *)RECORD_FIELD(worst_packed, &r[i], index);
+    }
+    return acc;
+}
+
+static uint64_t sum_decl_indexed(const worst_decl_t *r, size_t n, size_t index) {
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) {
+        acc += (uint64_t)*(const int *)RECORD_FIELD(worst_decl, &r[i], index);
+    }
+    return acc;
+}
+
+int bench_packed(int argc, char **argv) {
+    size_t n = arg_count(argc, argv, 1, 4000000);
+    human1_t *src = malloc(n * sizeof *src);
+    worst_decl_t *decl = malloc(n * sizeof *decl);
+    worst_packed_t *packed = malloc(n * sizeof *packed);
+    volatile size_t age_index = AGE_INDEX;
+    struct FieldDesc worst_decl_fields[] = {
+        FIELD(worst_decl_t, first_initial, 'F'),
+        FIELD(worst_decl_t, height,        'H'),
+        FIELD(worst_decl_t, age,           'A'),
+        FIELD(worst_decl_t, name,          'N'),
+    };
+    struct FieldDesc worst_packed_fields[] = {
+        FIELD(worst_packed_t, first_initial, 'F'),
+        FIELD(worst_packed_t, height,        'H'),
+        FIELD(worst_packed_t, age,           'A'),
+        FIELD(worst_packed_t, name,          'N'),
+    };
+    struct FieldDesc sensor_decl_fields[] = {
+        FIELD(sensor_decl_t, kind,      'K'),
+        FIELD(sensor_decl_t, value,     'V'),
+        FIELD(sensor_decl_t, unit,      'U'),
+        FIELD(sensor_decl_t, id,        'I'),
+        FIELD(sensor_decl_t, flags,     'F'),
+        FIELD(sensor_decl_t, timestamp, 'T'),
+        FIELD(sensor_decl_t, channel,   'C'),
+    };
+    struct FieldDesc sensor_packed_fields[] = {
+        FIELD(sensor_packed_t, kind,      'K'),
+        FIELD(sensor_packed_t, value,     'V'),
+        FIELD(sensor_packed_t, unit,      'U'),
+        FIELD(sensor_packed_t, id,        'I'),
+        FIELD(sensor_packed_t, flags,     'F'),
+        FIELD(sensor_packed_t, timestamp, 'T'),
+        FIELD(sensor_packed_t, channel,   'C'),
+    };
+    uint64_t expect = 0, acc, t0, dt;
+    int status = 1;
+
+    visualize("worst_decl_t (list order)", sizeof(worst_decl_t), worst_decl_fields,
+              NFIELDS(worst_decl_fields));
+    visualize("worst_packed_t (PACKED_RECORD)", sizeof(worst_packed_t), worst_packed_fields,
+              NFIELDS(worst_packed_fields));
+    visualize("sensor_decl_t (list order)", sizeof(sensor_decl_t), sensor_decl_fields,
+              NFIELDS(sensor_decl_fields));
+    padding_report("sensor_decl_t", sizeof(sensor_decl_t), alignof(sensor_decl_t),
+                   sensor_decl_fields, NFIELDS(sensor_decl_fields));
+    visualize("sensor_packed_t (PACKED_RECORD)", sizeof(sensor_packed_t), sensor_packed_fields,
+              NFIELDS(sensor_packed_fields));
+    printf("\nmember offsets in list order:\n");
+    for (size_t i = 0; i < sensor_packed_nfields; i++) {
+        printf("  %zu: %-10s declared @%2zu  packed @%2zu\n", i, sensor_decl_fields[i].name,
+               sensor_decl_offset(i), sensor_packed_offset(i));
+    }
+
+    if (!src || !decl || !packed) {
+        fprintf(stderr, "bench-packed: cannot allocate %zu records\n", n);
+        goto out;
+    }
+    human_fill(src, n, 37);
+    for (size_t i = 0; i < n; i++) {
+        decl[i].first_initial = packed[i].first_initial = src[i].first_initial;
+        decl[i].height = packed[i].height = src[i].height;
+        decl[i].age = packed[i].age = src[i].age;
+        decl[i].name = packed[i].name = src[i].name;
+        expect += (uint64_t)src[i].age;
+    }
+
+    printf("\nsum of age over %zu records (ns/record):\n", n);
+    printf("%-34s %6s %8s\n", "variant", "bytes", "ns");
+#define RUN(label, size, call)                                                             \
+    t0 = now_ns();                                                                         \
+    acc = (call);                                                                          \
+    dt = now_ns() - t0;                                                                    \
+    printf("%-34s %6zu %8.3f%s\n", label, (size_t)(size), (double)dt / (double)n,          \
+           acc == expect ? "" : "  MISMATCH");                                             \
+    bench_sink += acc;
+    RUN("declared, by name", sizeof(worst_decl_t), sum_decl_named(decl, n))
+    RUN("declared, by index", sizeof(worst_decl_t), sum_decl_indexed(decl, n, age_index))
+    RUN("PACKED_RECORD, by name", sizeof(worst_packed_t), sum_packed_named(packed, n))
+    RUN("PACKED_RECORD, by index", sizeof(worst_packed_t),
+        sum_packed_indexed(packed, n, age_index))
+#undef RUN
+    status = 0;
+
+out:
+    free(src);
+    free(decl);
+    free(packed);
+    return status;
+}
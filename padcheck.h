@@ -0,0 +1,14 @@
+#ifndef PADCHECK_H
+#define PADCHECK_H
+
+// Records the expected size of a hot struct, e.g.
+//   typedef struct PADCHECK_HOT(32) Human1 { ... } human1_t;
+// The padcheck GCC plugin (plugin/padcheck.cc, `make check-padding`) warns
+// when the size changes. Outside that build the macro expands to nothing.
+#ifdef PADCHECK
+#define PADCHECK_HOT(size) __attribute__((padcheck_hot(size)))
+#else
+#define PADCHECK_HOT(size)
+#endif
+
+#endif
@@ -0,0 +1,225 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "bench.h"
+#include "commands.h"
+#include "human.h"
+#include "layout.h"
+#include "loader.h"
+#include "lz.h"
+
+// Storage cost of padding. Each layout is written three ways:
+//   raw       records assigned field by field into recycled memory, so the
+//             padding holds whatever was there before (random bytes here)
+//   zeroed    the same records with every padding byte cleared
+//   stripped  only the member bytes, as described by the FieldDesc table
+// Every file is kept in `dir` as padding_<layout>_<variant>.bin, read back,
+// compressed with the built-in LZ codec (lz.h) and the result written next
+// to it as .bin.lz; the report gives both on-disk sizes.
+
+static uint64_t next_random(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static void fill_garbage(void *buf, size_t bytes, uint64_t seed) {
+    unsigned char *p = buf;
+    uint64_t state = seed;
+    for (size_t i = 0; i + 8 <= bytes; i += 8) {
+        uint64_t r = next_random(&state);
+        memcpy(p + i, &r, sizeof r);
+    }
+    for (size_t i = bytes / 8 * 8; i < bytes; i++) p[i] = (unsigned char)next_random(&state);
+}
+
+static void zero_padding(unsigned char *records, size_t n, size_t sz, const unsigned char *mask) {
+    for (size_t r = 0; r < n; r++) {
+        for (size_t i = 0; i < sz; i++) {
+            if (!mask[i]) records[r * sz + i] = 0;
+        }
+    }
+}
+
+static size_t strip_padding(unsigned char *out, const unsigned char *records, size_t n, size_t sz,
+                            const unsigned char *mask) {
+    unsigned char *op = out;
+    for (size_t r = 0; r < n; r++) {
+        const unsigned char *rec = records + r * sz;
+        for (size_t i = 0; i < sz; i++) {
+            if (mask[i]) *op++ = rec[i];
+        }
+    }
+    return (size_t)(op - out);
+}
+
+struct PadLayout {
+    const char *name;
+    size_t size;
+    const struct FieldDesc *fields;
+    size_t nfields;
+    void (*convert)(unsigned char *out, const human1_t *rows, size_t n);
+};
+
+static void to_human1(unsigned char *out, const human1_t *rows, size_t n) {
+    human1_t *h = (human1_t *)out;
+    // Field-wise assignment leaves the padding bytes untouched.
+    for (size_t i = 0; i < n; i++) {
+        h[i].first_initial = rows[i].first_initial;
+        h[i].age = rows[i].age;
+        h[i].height = rows[i].height;
+        h[i].name = rows[i].name;
+    }
+}
+
+static void to_worst(unsigned char *out, const human1_t *rows, size_t n) {
+    human_to_worst((human_worst_t *)out, rows, n);
+}
+
+static void to_slim(unsigned char *out, const human1_t *rows, size_t n) {
+    human_to_slim((human_slim_t *)out, rows, n);
+}
+
+struct ReadBack {
+    unsigned char *buf;
+    size_t cap;
+};
+
+static int read_back_chunk(const void *data, size_t len, uint64_t offset, void *ctx) {
+    struct ReadBack *rb = ctx;
+    if (offset + len > rb->cap) return -1;
+    memcpy(rb->buf + offset, data, len);
+    return 0;
+}
+
+static off_t file_size(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0 ? st.st_size : -1;
+}
+
+static int compress_report(const char *layout, const char *variant, const unsigned char *data,
+                           size_t bytes, const char *dir) {
+    size_t cap = lz_bound(bytes), packed, unpacked;
+    unsigned char *file = malloc(bytes), *comp = malloc(cap), *back = malloc(bytes);
+    struct ReadBack rb = {file, bytes};
+    struct LoadStats stats;
+    char path[4096], lz_path[4100];
+    off_t raw_size, lz_size;
+    uint64_t t0, tc, td;
+    int status = -1;
+
+    if (!file || !comp || !back) goto out;
+    snprintf(path, sizeof path, "%s/padding_%s_%s.bin", dir, layout, variant);
+    snprintf(lz_path, sizeof lz_path, "%s.lz", path);
+    if (write_record_file(path, data, bytes) != 0) {
+        fprintf(stderr, "padding-files: cannot write %s: %s\n", path, strerror(errno));
+        goto out;
+    }
+    if (load_file(path, LOAD_READ, 1u << 20, 1, read_back_chunk, &rb, &stats) != 0 ||
+        stats.bytes != bytes) {
+        fprintf(stderr, "padding-files: cannot read back %s\n", path);
+        goto out;
+    }
+
+    t0 = now_ns();
+    packed = lz_compress(file, bytes, comp, cap);
+    tc = now_ns() - t0;
+    t0 = now_ns();
+    unpacked = lz_decompress(comp, packed, back, bytes);
+    td = now_ns() - t0;
+    if (packed == 0 || unpacked != bytes || memcmp(back, file, bytes) != 0) {
+        fprintf(stderr, "padding-files: round trip failed for %s/%s\n", layout, variant);
+        goto out;
+    }
+    if (write_record_file(lz_path, comp, packed) != 0) {
+        fprintf(stderr, "padding-files: cannot write %s: %s\n", lz_path, strerror(errno));
+        goto out;
+    }
+    raw_size = file_size(path);
+    lz_size = file_size(lz_path);
+    if (raw_size <= 0 || lz_size <= 0) {
+        fprintf(stderr, "padding-files: cannot stat %s\n", path);
+        goto out;
+    }
+    printf("%-7s %-9s %10.1f %10.1f %7.2f %10.1f %10.1f\n", layout, variant,
+           (double)raw_size / (1024.0 * 1024.0), (double)lz_size / (1024.0 * 1024.0),
+           (double)raw_size / (double)lz_size, (double)bytes / ((double)tc / 1e9) / 1e6,
+           (double)bytes / ((double)td / 1e9) / 1e6);
+    status = 0;
+
+out:
+    free(file);
+    free(comp);
+    free(back);
+    return status;
+}
+
+int padding_files(int argc, char **argv) {
+    size_t n = arg_count(argc, argv, 1, 2000000);
+    const char *dir = argc > 2 ? argv[2] : ".";
+    struct FieldDesc human1_fields[] = {
+        FIELD(human1_t, first_initial, 'F'),
+        FIELD(human1_t, age,           'A'),
+        FIELD(human1_t, height,        'H'),
+        FIELD(human1_t, name,          'N'),
+    };
+    struct FieldDesc worst_fields[] = {
+        FIELD(human_worst_t, first_initial, 'F'),
+        FIELD(human_worst_t, height,        'H'),
+        FIELD(human_worst_t, age,           'A'),
+        FIELD(human_worst_t, name,          'N'),
+    };
+    struct FieldDesc slim_fields[] = {
+        FIELD(human_slim_t, height_cm,     'H'),
+        FIELD(human_slim_t, age,           'A'),
+        FIELD(human_slim_t, first_initial, 'F'),
+        FIELD(human_slim_t, name_id,       'N'),
+    };
+    const struct PadLayout layouts[] = {
+        {"human1", sizeof(human1_t), human1_fields, NFIELDS(human1_fields), to_human1},
+        {"worst", sizeof(human_worst_t), worst_fields, NFIELDS(worst_fields), to_worst},
+        {"slim", sizeof(human_slim_t), slim_fields, NFIELDS(slim_fields), to_slim},
+    };
+    human1_t *src = malloc(n * sizeof *src);
+    unsigned char *records = malloc(n * sizeof(human_worst_t));
+    unsigned char *stripped = malloc(n * sizeof(human_worst_t));
+    int status = 1;
+
+    if (!src || !records || !stripped) {
+        fprintf(stderr, "padding-files: cannot allocate %zu records\n", n);
+        goto out;
+    }
+    human_fill(src, n, 31);
+
+    printf("Record files of %zu records in %s, compressed with lz.h:\n", n, dir);
+    printf("%-7s %-9s %10s %10s %7s %10s %10s\n", "layout", "variant", "file MiB", ".lz MiB", "ratio",
+           "comp MB/s", "dec MB/s");
+    for (size_t l = 0; l < sizeof layouts / sizeof layouts[0]; l++) {
+        const struct PadLayout *L = &layouts[l];
+        unsigned char mask[64];
+        size_t members = layout_member_mask(L->size, L->fields, L->nfields, mask);
+        size_t bytes = n * L->size, stripped_bytes;
+
+        fill_garbage(records, bytes, 0x5eed + l);
+        L->convert(records, src, n);
+        if (compress_report(L->name, "raw", records, bytes, dir) != 0) goto out;
+        zero_padding(records, n, L->size, mask);
+        if (compress_report(L->name, "zeroed", records, bytes, dir) != 0) goto out;
+        stripped_bytes = strip_padding(stripped, records, n, L->size, mask);
+        if (compress_report(L->name, "stripped", stripped, stripped_bytes, dir) != 0) goto out;
+        printf("%-7s %zu of %zu bytes per record are padding\n", "", L->size - members, L->size);
+    }
+    status = 0;
+
+out:
+    free(src);
+    free(records);
+    free(stripped);
+    return status;
+}
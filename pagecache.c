@@ -0,0 +1,169 @@
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "commands.h"
+#include "human.h"
+#include "loader.h"
+
+// Whole I/O cost of a record file per layout: every variant starts with the
+// file evicted, scans all records and reports throughput, the page faults
+// the scan took (getrusage) and how much of the file mincore() finds in the
+// page cache afterwards. Padding inflates all three in proportion to the
+// record size.
+
+enum ScanVariant { VAR_MMAP, VAR_MMAP_SEQ, VAR_MMAP_POPULATE, VAR_READ_64K, VAR_READ_1M };
+
+static const char *variant_name(enum ScanVariant v) {
+    switch (v) {
+    case VAR_MMAP:          return "mmap";
+    case VAR_MMAP_SEQ:      return "mmap+SEQUENTIAL";
+    case VAR_MMAP_POPULATE: return "mmap+POPULATE";
+    case VAR_READ_64K:      return "read 64K buffer";
+    case VAR_READ_1M:       return "read 1M buffer";
+    }
+    return "?";
+}
+
+static int scan_mmap(const char *path, int flags, int advice, struct RecordScan *scan) {
+    struct stat st;
+    void *map;
+    int status, fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return -1;
+    }
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE | flags, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return -1;
+    if (advice) madvise(map, (size_t)st.st_size, advice);
+    status = record_scan_chunk(map, (size_t)st.st_size, 0, scan);
+    munmap(map, (size_t)st.st_size);
+    return status;
+}
+
+// Fraction of the file's pages resident in the page cache.
+static double residency(const char *path) {
+    struct stat st;
+    long page = sysconf(_SC_PAGESIZE);
+    size_t pages, resident = 0;
+    unsigned char *vec;
+    void *map;
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0) return -1.0;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return -1.0;
+    }
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return -1.0;
+    pages = ((size_t)st.st_size + (size_t)page - 1) / (size_t)page;
+    vec = malloc(pages);
+    if (vec && mincore(map, (size_t)st.st_size, vec) == 0) {
+        for (size_t i = 0; i < pages; i++) resident += vec[i] & 1;
+    }
+    free(vec);
+    munmap(map, (size_t)st.st_size);
+    return (double)resident / (double)pages;
+}
+
+static int run_variant(const char *path, enum ScanVariant v, struct RecordScan *scan) {
+    struct LoadStats stats;
+    switch (v) {
+    case VAR_MMAP:          return scan_mmap(path, 0, 0, scan);
+    case VAR_MMAP_SEQ:      return scan_mmap(path, 0, MADV_SEQUENTIAL, scan);
+    case VAR_MMAP_POPULATE: return scan_mmap(path, MAP_POPULATE, 0, scan);
+    case VAR_READ_64K:
+        return load_file(path, LOAD_READ, 64 << 10, 0, record_scan_chunk, scan, &stats);
+    case VAR_READ_1M:
+        return load_file(path, LOAD_READ, 1 << 20, 0, record_scan_chunk, scan, &stats);
+    }
+    return -1;
+}
+
+int bench_pagecache(int argc, char **argv) {
+    size_t n = arg_count(argc, argv, 1, 4000000);
+    const char *dir = argc > 2 ? argv[2] : ".";
+    human1_t *src = malloc(n * sizeof *src);
+    human_worst_t *worst = malloc(n * sizeof *worst);
+    human_slim_t *slim = malloc(n * sizeof *slim);
+    struct FieldDesc ages[] = {
+        FIELD(human_worst_t, age, 'A'),
+        FIELD(human1_t,      age, 'A'),
+        FIELD(human_slim_t,  age, 'A'),
+    };
+    const char *names[] = {"worst", "human1", "slim"};
+    const void *data[3];
+    size_t sizes[] = {sizeof(human_worst_t), sizeof(human1_t), sizeof(human_slim_t)};
+    long page = sysconf(_SC_PAGESIZE);
+    char path[4096];
+    int status = 1;
+
+    if (!src || !worst || !slim) {
+        fprintf(stderr, "bench-pagecache: cannot allocate %zu records\n", n);
+        goto out;
+    }
+    human_fill(src, n, 29);
+    human_to_worst(worst, src, n);
+    human_to_slim(slim, src, n);
+    data[0] = worst;
+    data[1] = src;
+    data[2] = slim;
+
+    printf("Cold scans of %zu-record files (page size %ld):\n", n, page);
+    printf("%-7s %9s %8s %-16s %9s %9s %8s %9s\n", "layout", "MiB", "pages", "variant", "MB/s",
+           "minflt", "majflt", "resident");
+    for (size_t f = 0; f < 3; f++) {
+        size_t bytes = n * sizes[f];
+        snprintf(path, sizeof path, "%s/pagecache_%s.bin", dir, names[f]);
+        if (write_record_file(path, data[f], bytes) != 0) {
+            fprintf(stderr, "bench-pagecache: cannot write %s: %s\n", path, strerror(errno));
+            goto out;
+        }
+        for (enum ScanVariant v = VAR_MMAP; v <= VAR_READ_1M; v++) {
+            struct RecordScan scan;
+            struct rusage before, after;
+            uint64_t t0, dt;
+
+            memset(&scan, 0, sizeof scan);
+            scan.record_size = sizes[f];
+            scan.field = &ages[f];
+            evict_file(path);
+            getrusage(RUSAGE_SELF, &before);
+            t0 = now_ns();
+            if (run_variant(path, v, &scan) != 0 || scan.records != n) {
+                fprintf(stderr, "bench-pagecache: %s scan of %s failed\n", variant_name(v), path);
+                unlink(path);
+                goto out;
+            }
+            dt = now_ns() - t0;
+            getrusage(RUSAGE_SELF, &after);
+            bench_sink += scan.checksum;
+            printf("%-7s %9.1f %8zu %-16s %9.1f %9ld %8ld %8.1f%%\n", names[f],
+                   (double)bytes / (1024.0 * 1024.0), (bytes + (size_t)page - 1) / (size_t)page,
+                   variant_name(v), (double)bytes / ((double)dt / 1e9) / 1e6,
+                   after.ru_minflt - before.ru_minflt, after.ru_majflt - before.ru_majflt,
+                   100.0 * residency(path));
+        }
+        unlink(path);
+    }
+    status = 0;
+
+out:
+    free(src);
+    free(worst);
+    free(slim);
+    return status;
+}
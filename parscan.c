@@ -0,0 +1,256 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "commands.h"
+#include "human.h"
+#include "layout.h"
+#include "parscan.h"
+
+#define CACHE_LINE 64
+#define MAX_THREADS 256
+
+// A worker's remaining chunk range [next, end) packed into one word so the
+// owner (taking from the front) and thieves (taking the back half) race
+// through a single compare-exchange.
+struct Worker {
+    alignas(CACHE_LINE) _Atomic uint64_t range;
+    const struct ParScan *scan;
+    struct Worker *all;
+    unsigned id;
+};
+
+static inline uint64_t pack_range(uint32_t next, uint32_t end) {
+    return (uint64_t)next << 32 | end;
+}
+
+size_t parallel_scan_partial_stride(size_t partial_size) {
+    return (partial_size + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+}
+
+void *parallel_scan_partial(const struct ParScan *scan, unsigned thread) {
+    return (char *)scan->partials + thread * parallel_scan_partial_stride(scan->partial_size);
+}
+
+static int take_front(struct Worker *w, uint32_t *chunk) {
+    uint64_t r = atomic_load(&w->range);
+    for (;;) {
+        uint32_t next = (uint32_t)(r >> 32), end = (uint32_t)r;
+        if (next >= end) return 0;
+        if (atomic_compare_exchange_weak(&w->range, &r, pack_range(next + 1, end))) {
+            *chunk = next;
+            return 1;
+        }
+    }
+}
+
+static int steal_half(struct Worker *thief) {
+    unsigned n = thief->scan->nthreads;
+    for (unsigned k = 1; k < n; k++) {
+        struct Worker *victim = &thief->all[(thief->id + k) % n];
+        uint64_t r = atomic_load(&victim->range);
+        for (;;) {
+            uint32_t next = (uint32_t)(r >> 32), end = (uint32_t)r, mid;
+            if (next >= end) break;
+            mid = next + (end - next) / 2;
+            if (atomic_compare_exchange_weak(&victim->range, &r, pack_range(next, mid))) {
+                atomic_store(&thief->range, pack_range(mid, end));
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+static void *worker_main(void *arg) {
+    struct Worker *w = arg;
+    const struct ParScan *s = w->scan;
+    void *partial = parallel_scan_partial(s, w->id);
+    uint32_t chunk;
+
+    do {
+        while (take_front(w, &chunk)) {
+            size_t begin = (size_t)chunk * s->chunk_records;
+            size_t end = begin + s->chunk_records < s->count ? begin + s->chunk_records : s->count;
+            s->fn(s->base, begin, end, partial, s->ctx);
+        }
+    } while (steal_half(w));
+    return NULL;
+}
+
+int parallel_scan(const struct ParScan *scan) {
+    struct ParScan s = *scan;
+    struct Worker *workers;
+    pthread_t threads[MAX_THREADS];
+    size_t nchunks;
+    unsigned started = 1;
+    int status = 0;
+
+    if (s.nthreads == 0) s.nthreads = 1;
+    if (s.nthreads > MAX_THREADS) s.nthreads = MAX_THREADS;
+    if (s.chunk_records == 0) {
+        s.chunk_records = (64 * 1024) / s.record_size;
+        if (s.chunk_records == 0) s.chunk_records = 1;
+    }
+    nchunks = (s.count + s.chunk_records - 1) / s.chunk_records;
+    while (nchunks > UINT32_MAX) {
+        s.chunk_records *= 2;
+        nchunks = (s.count + s.chunk_records - 1) / s.chunk_records;
+    }
+
+    workers = aligned_alloc(CACHE_LINE, s.nthreads * sizeof *workers);
+    if (!workers) return -1;
+    for (unsigned t = 0; t < s.nthreads; t++) {
+        atomic_init(&workers[t].range, pack_range((uint32_t)(nchunks * t / s.nthreads),
+                                                  (uint32_t)(nchunks * (t + 1) / s.nthreads)));
+        workers[t].scan = &s;
+        workers[t].all = workers;
+        workers[t].id = t;
+    }
+
+    // Thread 0 is the caller.
+    for (; started < s.nthreads; started++) {
+        if (pthread_create(&threads[started], NULL, worker_main, &workers[started]) != 0) {
+            status = -1;
+            break;
+        }
+    }
+    worker_main(&workers[0]);
+    // A worker that failed to start leaves its chunks to be stolen.
+    for (unsigned t = 1; t < started; t++) pthread_join(threads[t], NULL);
+    free(workers);
+    return status;
+}
+
+// Scaling benchmark: sum(height) and count of adults over arrays of three
+// layouts of the same logical record.
+
+struct ScanPartial {
+    double   height_sum;
+    uint64_t adults;
+};
+
+#define SCAN_KERNEL(T, fname, height_expr)                                               \
+    static void fname(const void *base, size_t begin, size_t end, void *partial,         \
+                      void *ctx) {                                                       \
+        const T *rows = base;                                                            \
+        struct ScanPartial *p = partial;                                                 \
+        double sum = 0.0;                                                                \
+        uint64_t adults = 0;                                                             \
+        (void)ctx;                                                                       \
+        for (size_t i = begin; i < end; i++) {                                           \
+            sum += height_expr;                                                          \
+            adults += (unsigned)rows[i].age - 18u <= 47u;                                \
+        }                                                                                \
+        p->height_sum += sum;                                                            \
+        p->adults += adults;                                                             \
+    }
+
+SCAN_KERNEL(human_worst_t, scan_worst, rows[i].height)
+SCAN_KERNEL(human2_t,      scan_human2, rows[i].height)
+SCAN_KERNEL(human_slim_t,  scan_slim, rows[i].height_cm * 0.01)
+
+static unsigned online_cpus(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (unsigned)n : 1;
+}
+
+int bench_parscan(int argc, char **argv) {
+    size_t n = arg_count(argc, argv, 1, 8000000);
+    unsigned max_threads = (unsigned)arg_count(argc, argv, 2, online_cpus());
+    human1_t *src = malloc(n * sizeof *src);
+    human_worst_t *worst = malloc(n * sizeof *worst);
+    human2_t *human2 = malloc(n * sizeof *human2);
+    human_slim_t *slim = malloc(n * sizeof *slim);
+    void *partials = NULL;
+    struct ScanLayout {
+        const char *label;
+        const void *base;
+        size_t size;
+        scan_chunk_fn fn;
+    } layouts[3];
+    struct FieldDesc worst_fields[] = {
+        FIELD(human_worst_t, first_initial, 'F'),
+        FIELD(human_worst_t, height,        'H'),
+        FIELD(human_worst_t, age,           'A'),
+        FIELD(human_worst_t, name,          'N'),
+    };
+    struct FieldDesc slim_fields[] = {
+        FIELD(human_slim_t, height_cm,     'H'),
+        FIELD(human_slim_t, age,           'A'),
+        FIELD(human_slim_t, first_initial, 'F'),
+        FIELD(human_slim_t, name_id,       'N'),
+    };
+    int status = 1;
+
+    if (max_threads > MAX_THREADS) max_threads = MAX_THREADS;
+    partials = aligned_alloc(CACHE_LINE,
+                             max_threads * parallel_scan_partial_stride(sizeof(struct ScanPartial)));
+    if (!src || !worst || !human2 || !slim || !partials) {
+        fprintf(stderr, "bench-parscan: cannot allocate %zu records\n", n);
+        goto out;
+    }
+    human_fill(src, n, 5);
+    human_to_human2(human2, src, n);
+    human_to_worst(worst, src, n);
+    human_to_slim(slim, src, n);
+    layouts[0] = (struct ScanLayout){"worst order", worst, sizeof *worst, scan_worst};
+    layouts[1] = (struct ScanLayout){"human2_t", human2, sizeof *human2, scan_human2};
+    layouts[2] = (struct ScanLayout){"slim", slim, sizeof *slim, scan_slim};
+
+    visualize("HumanWorst", sizeof(human_worst_t), worst_fields, NFIELDS(worst_fields));
+    visualize("HumanSlim", sizeof(human_slim_t), slim_fields, NFIELDS(slim_fields));
+
+    printf("\nParallel scan of %zu records, 1..%u threads (best of 3):\n", n, max_threads);
+    printf("%-12s %6s %8s %10s %8s %8s\n", "layout", "bytes", "threads", "ms", "GB/s", "speedup");
+    for (size_t l = 0; l < 3; l++) {
+        double base_ms = 0.0;
+        uint64_t expect_adults = 0;
+        // Thread counts double from 1 and end at max_threads.
+        for (unsigned t = 1;; t = t * 2 < max_threads ? t * 2 : max_threads) {
+            struct ParScan scan = {layouts[l].base, n, layouts[l].size, 0, t, layouts[l].fn,
+                                   NULL, partials, sizeof(struct ScanPartial)};
+            uint64_t best = UINT64_MAX, adults = 0;
+            double ms;
+            for (int rep = 0; rep < 3; rep++) {
+                uint64_t t0, dt;
+                memset(partials, 0, t * parallel_scan_partial_stride(scan.partial_size));
+                t0 = now_ns();
+                if (parallel_scan(&scan) != 0) {
+                    fprintf(stderr, "bench-parscan: could not start all threads\n");
+                }
+                dt = now_ns() - t0;
+                best = dt < best ? dt : best;
+            }
+            for (unsigned w = 0; w < t; w++) {
+                adults += ((struct ScanPartial *)parallel_scan_partial(&scan, w))->adults;
+            }
+            bench_sink += adults;
+            ms = (double)best / 1e6;
+            if (t == 1) {
+                base_ms = ms;
+                expect_adults = adults;
+            }
+            printf("%-12s %6zu %8u %10.1f %8.2f %8.2f%s\n", layouts[l].label, layouts[l].size, t,
+                   ms, (double)(n * layouts[l].size) / (double)best, base_ms / ms,
+                   adults == expect_adults ? "" : "  MISMATCH");
+            if (t == max_threads) break;
+        }
+    }
+    status = 0;
+
+out:
+    free(src);
+    free(worst);
+    free(human2);
+    free(slim);
+    free(partials);
+    return status;
+}
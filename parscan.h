@@ -0,0 +1,37 @@
+#ifndef PARSCAN_H
+#define PARSCAN_H
+
+#include <stddef.h>
+
+// Parallel scan over an array of fixed-size records. The array is cut into
+// chunks of `chunk_records`; each worker starts on a contiguous share of the
+// chunks and, once it runs dry, steals half of the remaining chunks of
+// another worker. Each worker folds its chunks into its own partial result.
+
+// Processes records [begin, end) of `base` into `partial`.
+typedef void (*scan_chunk_fn)(const void *base, size_t begin, size_t end, void *partial,
+                              void *ctx);
+
+struct ParScan {
+    const void   *base;
+    size_t        count;
+    size_t        record_size;
+    size_t        chunk_records;  // 0: pick ~64 KiB chunks
+    unsigned      nthreads;
+    scan_chunk_fn fn;
+    void         *ctx;
+    // Zero-initialized per-thread partials, each `partial_size` bytes apart
+    // in the caller's buffer as laid out by parallel_scan_partial().
+    void         *partials;
+    size_t        partial_size;
+};
+
+// Stride between partials: partial_size rounded up to a cache line so
+// workers never write to the same line.
+size_t parallel_scan_partial_stride(size_t partial_size);
+void  *parallel_scan_partial(const struct ParScan *scan, unsigned thread);
+
+// Returns 0 on success, -1 if a worker thread could not be started.
+int parallel_scan(const struct ParScan *scan);
+
+#endif
@@ -0,0 +1,218 @@
+// GCC plugin: padding and size budgets for struct types, checked while the
+// code compiles.
+//
+//   make plugin           builds plugin/padcheck.so (needs the GCC plugin
+//                         headers, e.g. gcc-12-plugin-dev)
+//   make check-padding    compiles the tree with the plugin loaded
+//
+// Arguments, as -fplugin-arg-padcheck-<key>=<value>:
+//   max-padding=N  warn when a struct has more than N bytes of padding
+//   max-lines=N    warn when a struct spans more than N 64-byte cache lines
+// Independently of both, a struct declared with PADCHECK_HOT(size)
+// (padcheck.h) warns when its size is no longer `size`.
+//
+// Members are turned into the same FieldDesc descriptors the FIELD() macros
+// produce and measured with layout_member_mask() from layout.c, so the
+// plugin counts padding exactly as visualize() and padding_report() do.
+// Structs from system headers are skipped.
+
+// GCC's system.h wants C++ standard headers included before it.
+#include <set>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "gcc-plugin.h"
+#include "plugin-version.h"
+#include "tree.h"
+#include "stringpool.h"
+#include "attribs.h"
+#include "diagnostic-core.h"
+
+extern "C" {
+#include "../layout.h"
+}
+
+#define CACHE_LINE 64
+
+int plugin_is_GPL_compatible;
+
+static long max_padding = -1;  // -1: no budget
+static long max_lines = -1;
+static std::set<tree> hot_checked;
+
+static const char *record_name(tree type) {
+    tree name = TYPE_NAME(type);
+    if (name && TREE_CODE(name) == TYPE_DECL) name = DECL_NAME(name);
+    return name ? IDENTIFIER_POINTER(name) : "(anonymous)";
+}
+
+// Flattens the members of `type` into descriptors at offsets relative to the
+// outermost struct. Anonymous struct and union members are descended into;
+// named struct members stay one opaque field, as in the FIELD() tables.
+static void collect_fields(tree type, unsigned HOST_WIDE_INT base,
+                           std::vector<struct FieldDesc> &out) {
+    for (tree f = TYPE_FIELDS(type); f; f = DECL_CHAIN(f)) {
+        unsigned HOST_WIDE_INT bitpos, bits, offset;
+        struct FieldDesc d;
+
+        if (TREE_CODE(f) != FIELD_DECL || !tree_fits_uhwi_p(bit_position(f))) continue;
+        bitpos = tree_to_uhwi(bit_position(f));
+        offset = base + bitpos / BITS_PER_UNIT;
+        if (!DECL_NAME(f) && RECORD_OR_UNION_TYPE_P(TREE_TYPE(f))) {
+            collect_fields(TREE_TYPE(f), offset, out);
+            continue;
+        }
+        // Flexible array members have no size; their storage is not padding.
+        if (!DECL_SIZE(f) || !tree_fits_uhwi_p(DECL_SIZE(f))) continue;
+        bits = tree_to_uhwi(DECL_SIZE(f));
+        if (bits == 0) continue;
+
+        memset(&d, 0, sizeof d);
+        d.name = DECL_NAME(f) ? IDENTIFIER_POINTER(DECL_NAME(f)) : "(unnamed)";
+        d.offset = offset;
+        // A bit-field covers every byte its bits touch.
+        d.size = (bitpos % BITS_PER_UNIT + bits + BITS_PER_UNIT - 1) / BITS_PER_UNIT;
+        d.elem_size = d.size;
+        d.align = DECL_ALIGN_UNIT(f);
+        d.kind = FD_MEMBER;
+        out.push_back(d);
+    }
+}
+
+// Finds the longest run of padding bytes and the member that follows it.
+static void largest_gap(const std::vector<unsigned char> &mask,
+                        const std::vector<struct FieldDesc> &fields, size_t *gap,
+                        const char **before) {
+    size_t best = 0, best_end = 0, run = 0;
+    for (size_t i = 0; i <= mask.size(); i++) {
+        if (i < mask.size() && !mask[i]) {
+            run++;
+            continue;
+        }
+        if (run > best) {
+            best = run;
+            best_end = i;
+        }
+        run = 0;
+    }
+    *gap = best;
+    *before = "the end (tail padding)";
+    for (size_t f = 0; f < fields.size(); f++) {
+        if (fields[f].offset == best_end) *before = fields[f].name;
+    }
+}
+
+// Warns once per type when a PADCHECK_HOT(size) struct is not `size` bytes.
+static void check_hot(tree type, location_t loc, unsigned HOST_WIDE_INT size,
+                      unsigned HOST_WIDE_INT padding) {
+    tree hot = lookup_attribute("padcheck_hot", TYPE_ATTRIBUTES(type));
+    unsigned HOST_WIDE_INT want;
+
+    if (!hot || !TREE_VALUE(hot) || !tree_fits_uhwi_p(TREE_VALUE(TREE_VALUE(hot)))) return;
+    if (!hot_checked.insert(type).second) return;
+    want = tree_to_uhwi(TREE_VALUE(TREE_VALUE(hot)));
+    if (want != size) {
+        warning_at(loc, 0, "hot struct %qs is %wu bytes but is annotated as %wu (%wu bytes of "
+                   "padding)",
+                   record_name(type), size, want, padding);
+    }
+}
+
+static void finish_type(void *gcc_data, void *) {
+    tree type = (tree)gcc_data;
+    location_t loc;
+    unsigned HOST_WIDE_INT size, padding;
+    std::vector<struct FieldDesc> fields;
+    std::vector<unsigned char> mask;
+    const char *name;
+
+    if (!type || TREE_CODE(type) != RECORD_TYPE || !COMPLETE_TYPE_P(type) ||
+        !tree_fits_uhwi_p(TYPE_SIZE_UNIT(type))) {
+        return;
+    }
+    loc = TYPE_STUB_DECL(type) ? DECL_SOURCE_LOCATION(TYPE_STUB_DECL(type)) : input_location;
+    if (in_system_header_at(loc)) return;
+
+    name = record_name(type);
+    size = tree_to_uhwi(TYPE_SIZE_UNIT(type));
+    collect_fields(type, 0, fields);
+    mask.resize(size);
+    padding = size - layout_member_mask(size, fields.data(), fields.size(), mask.data());
+
+    if (max_padding >= 0 && padding > (unsigned HOST_WIDE_INT)max_padding) {
+        size_t gap;
+        const char *before;
+        largest_gap(mask, fields, &gap, &before);
+        warning_at(loc, 0, "struct %qs has %wu of %wu bytes of padding (budget %ld); "
+                   "largest gap is %wu bytes before %qs",
+                   name, padding, size, max_padding, (unsigned HOST_WIDE_INT)gap, before);
+    }
+    if (max_lines >= 0 &&
+        (size + CACHE_LINE - 1) / CACHE_LINE > (unsigned HOST_WIDE_INT)max_lines) {
+        warning_at(loc, 0, "struct %qs is %wu bytes, more than %ld cache lines", name, size,
+                   max_lines);
+    }
+    check_hot(type, loc, size, padding);
+}
+
+// The hot-size check for typedefs, whose struct is complete with all of its
+// attributes applied even if the front end attaches them after
+// PLUGIN_FINISH_TYPE has run.
+static void finish_decl(void *gcc_data, void *) {
+    tree decl = (tree)gcc_data, type;
+    unsigned HOST_WIDE_INT size;
+    std::vector<struct FieldDesc> fields;
+    std::vector<unsigned char> mask;
+
+    if (!decl || TREE_CODE(decl) != TYPE_DECL) return;
+    type = TYPE_MAIN_VARIANT(TREE_TYPE(decl));
+    if (TREE_CODE(type) != RECORD_TYPE || !COMPLETE_TYPE_P(type) ||
+        !tree_fits_uhwi_p(TYPE_SIZE_UNIT(type)) ||
+        in_system_header_at(DECL_SOURCE_LOCATION(decl))) {
+        return;
+    }
+    size = tree_to_uhwi(TYPE_SIZE_UNIT(type));
+    collect_fields(type, 0, fields);
+    mask.resize(size);
+    check_hot(type, DECL_SOURCE_LOCATION(decl), size,
+              size - layout_member_mask(size, fields.data(), fields.size(), mask.data()));
+}
+
+static tree handle_hot_attribute(tree *node, tree name, tree args, int, bool *no_add_attrs) {
+    if (!RECORD_OR_UNION_TYPE_P(*node) || TREE_CODE(TREE_VALUE(args)) != INTEGER_CST) {
+        warning(OPT_Wattributes, "%qE takes a struct type and an integer size", name);
+        *no_add_attrs = true;
+    }
+    return NULL_TREE;
+}
+
+static struct attribute_spec hot_attribute = {
+    "padcheck_hot", 1, 1, false, true, false, false, handle_hot_attribute, NULL,
+};
+
+static void register_attributes(void *, void *) {
+    register_attribute(&hot_attribute);
+}
+
+int plugin_init(struct plugin_name_args *info, struct plugin_gcc_version *version) {
+    if (!plugin_default_version_check(version, &gcc_version)) {
+        error("padcheck: built for GCC %s", gcc_version.basever);
+        return 1;
+    }
+    for (int i = 0; i < info->argc; i++) {
+        const char *key = info->argv[i].key, *value = info->argv[i].value;
+        long *budget = strcmp(key, "max-padding") == 0 ? &max_padding
+                       : strcmp(key, "max-lines") == 0 ? &max_lines
+                                                       : NULL;
+        if (!budget || !value) {
+            error("padcheck: unknown argument %qs (expected max-padding=N or max-lines=N)", key);
+            return 1;
+        }
+        *budget = atol(value);
+    }
+    register_callback(info->base_name, PLUGIN_ATTRIBUTES, register_attributes, NULL);
+    register_callback(info->base_name, PLUGIN_FINISH_TYPE, finish_type, NULL);
+    register_callback(info->base_name, PLUGIN_FINISH_DECL, finish_decl, NULL);
+    return 0;
+}
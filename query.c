@@ -0,0 +1,170 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "commands.h"
+#include "human.h"
+
+// A tiny vectorized query engine over human records:
+//
+//   SELECT name FROM humans WHERE age BETWEEN lo AND hi AND height >= min
+//
+// Rows are processed in batches. The age predicate runs over a whole batch
+// into a byte mask (a loop the compiler can vectorize when the column is
+// contiguous), the mask is compacted into a selection vector, the height
+// predicate only visits selected rows, and names are materialized last.
+//
+// Every operator reads its field through a ColumnView, so the same pipeline
+// runs over arrays of human1_t/human2_t (stride = sizeof the record) and
+// over SoA columns (stride = sizeof the field).
+
+#define QUERY_BATCH 1024
+
+struct ColumnView {
+    const char *base;
+    size_t stride;
+};
+
+struct HumanSource {
+    const char *label;
+    size_t count;
+    struct ColumnView age, height, name;
+};
+
+struct Query {
+    int age_lo, age_hi;
+    double min_height;
+};
+
+#define VIEW_AT(view, type, i) (*(const type *)((view).base + (i) * (view).stride))
+
+static void match_age_contig(const int *age, size_t n, int lo, int hi, uint8_t *mask) {
+    for (size_t i = 0; i < n; i++) {
+        mask[i] = (unsigned)(age[i] - lo) <= (unsigned)(hi - lo);
+    }
+}
+
+static void match_age_strided(struct ColumnView age, size_t begin, size_t n, int lo, int hi,
+                              uint8_t *mask) {
+    for (size_t i = 0; i < n; i++) {
+        mask[i] = (unsigned)(VIEW_AT(age, int, begin + i) - lo) <= (unsigned)(hi - lo);
+    }
+}
+
+static size_t mask_to_selection(const uint8_t *mask, size_t n, uint16_t *sel) {
+    size_t k = 0;
+    for (size_t i = 0; i < n; i++) {
+        sel[k] = (uint16_t)i;
+        k += mask[i];
+    }
+    return k;
+}
+
+static size_t refine_height(struct ColumnView height, size_t begin, double min,
+                            const uint16_t *sel, size_t n, uint16_t *out) {
+    size_t k = 0;
+    for (size_t i = 0; i < n; i++) {
+        out[k] = sel[i];
+        k += VIEW_AT(height, double, begin + sel[i]) >= min;
+    }
+    return k;
+}
+
+static void materialize_names(struct ColumnView name, size_t begin, const uint16_t *sel,
+                              size_t n, name_t *out) {
+    for (size_t i = 0; i < n; i++) out[i] = VIEW_AT(name, name_t, begin + sel[i]);
+}
+
+static size_t run_query(const struct HumanSource *src, const struct Query *q, uint64_t *checksum) {
+    uint8_t mask[QUERY_BATCH];
+    uint16_t sel[QUERY_BATCH], refined[QUERY_BATCH];
+    name_t names[QUERY_BATCH];
+    size_t total = 0;
+
+    for (size_t begin = 0; begin < src->count; begin += QUERY_BATCH) {
+        size_t n = src->count - begin < QUERY_BATCH ? src->count - begin : QUERY_BATCH;
+        size_t k;
+
+        if (src->age.stride == sizeof(int)) {
+            match_age_contig(&VIEW_AT(src->age, int, begin), n, q->age_lo, q->age_hi, mask);
+        } else {
+            match_age_strided(src->age, begin, n, q->age_lo, q->age_hi, mask);
+        }
+        k = mask_to_selection(mask, n, sel);
+        k = refine_height(src->height, begin, q->min_height, sel, k, refined);
+        materialize_names(src->name, begin, refined, k, names);
+
+        for (size_t i = 0; i < k; i++) *checksum += (unsigned char)names[i].first[0];
+        total += k;
+    }
+    return total;
+}
+
+#define ROW_SOURCE(label_, rows_, n_)                                                  \
+    (struct HumanSource){label_, n_,                                                   \
+                         {(const char *)&(rows_)[0].age, sizeof (rows_)[0]},           \
+                         {(const char *)&(rows_)[0].height, sizeof (rows_)[0]},        \
+                         {(const char *)&(rows_)[0].name, sizeof (rows_)[0]}}
+
+int bench_query(int argc, char **argv) {
+    size_t n = arg_count(argc, argv, 1, 4000000);
+    static const struct Query queries[] = {
+        {30, 39, 1.80},  // ~4% selected
+        {18, 65, 1.60},  // ~36% selected
+        {0, 99, 1.40},   // everything
+    };
+    human1_t *rows1 = malloc(n * sizeof *rows1);
+    human2_t *rows2 = malloc(n * sizeof *rows2);
+    human_columns_t cols;
+    struct HumanSource sources[3];
+
+    if (!rows1 || !rows2 || human_columns_init(&cols, n) != 0) {
+        fprintf(stderr, "bench-query: cannot allocate %zu records\n", n);
+        free(rows1);
+        free(rows2);
+        return 1;
+    }
+    human_fill(rows1, n, 42);
+    human_to_human2(rows2, rows1, n);
+    human_columns_from_rows(&cols, rows1);
+
+    sources[0] = ROW_SOURCE("AoS human1_t", rows1, n);
+    sources[1] = ROW_SOURCE("AoS human2_t", rows2, n);
+    sources[2] = (struct HumanSource){"SoA columns", n,
+                                      {(const char *)cols.age, sizeof *cols.age},
+                                      {(const char *)cols.height, sizeof *cols.height},
+                                      {(const char *)cols.name, sizeof *cols.name}};
+
+    printf("Filter pipeline over %zu records (best of 5, Mrows/s):\n", n);
+    printf("%-14s", "layout");
+    for (size_t q = 0; q < sizeof queries / sizeof queries[0]; q++) {
+        printf("  age %2d-%-2d h>=%.2f  ", queries[q].age_lo, queries[q].age_hi,
+               queries[q].min_height);
+    }
+    printf("\n");
+
+    for (size_t s = 0; s < sizeof sources / sizeof sources[0]; s++) {
+        printf("%-14s", sources[s].label);
+        for (size_t q = 0; q < sizeof queries / sizeof queries[0]; q++) {
+            uint64_t best = UINT64_MAX, checksum = 0;
+            size_t selected = 0;
+            for (int rep = 0; rep < 5; rep++) {
+                uint64_t t0 = now_ns();
+                selected = run_query(&sources[s], &queries[q], &checksum);
+                uint64_t t1 = now_ns();
+                if (t1 - t0 < best) best = t1 - t0;
+            }
+            bench_sink += checksum;
+            printf("  %7.1f (%5.1f%% sel)", (double)n / ((double)best / 1e9) / 1e6,
+                   100.0 * (double)selected / (double)n);
+        }
+        printf("\n");
+    }
+
+    free(rows1);
+    free(rows2);
+    human_columns_free(&cols);
+    return 0;
+}
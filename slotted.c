@@ -0,0 +1,339 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdalign.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "commands.h"
+#include "human.h"
+#include "layout.h"
+
+// Slotted pages, the row-store format of most databases. A page starts with a
+// fixed header, a slot array grows up from it and variable-length tuples grow
+// down from the end; a slot holds the offset and length of its tuple, so
+// tuples can move within the page without changing their tuple id
+// (page << TID_SLOT_BITS | slot). Names are stored inline after the tuple
+// header instead of behind two pointers.
+
+#define PAGE_BYTES    8192
+#define TID_SLOT_BITS 10
+#define TUPLE_ALIGN   8
+
+typedef struct PageHeader {
+    uint64_t lsn;
+    uint16_t nslots;
+    uint16_t free_lower;  // end of the slot array
+    uint16_t free_upper;  // start of the tuple area
+    uint16_t flags;
+} page_header_t;
+
+typedef struct Slot {
+    uint16_t offset;
+    uint16_t length;
+} slot_t;
+
+// The tuple header in declaration order as it is often first written: 32
+// bytes, 16 of them padding, paid once per row.
+typedef struct TupleHeaderNaive {
+    char     first_initial;
+    double   height;
+    uint8_t  first_len;
+    int32_t  age;
+    uint8_t  last_len;
+    uint8_t  flags;
+} tuple_header_naive_t;
+
+// The same fields sorted by alignment: 16 bytes, no padding. The first and
+// last name bytes follow without a NUL.
+typedef struct TupleHeader {
+    double   height;
+    int32_t  age;
+    uint8_t  first_len;
+    uint8_t  last_len;
+    char     first_initial;
+    uint8_t  flags;
+} tuple_header_t;
+
+_Static_assert(sizeof(page_header_t) % alignof(slot_t) == 0, "slot array misaligned");
+_Static_assert(sizeof(tuple_header_t) == 16, "tuple header has padding");
+
+static inline page_header_t *page_header(unsigned char *page) {
+    return (page_header_t *)page;
+}
+
+static inline slot_t *page_slots(unsigned char *page) {
+    return (slot_t *)(page + sizeof(page_header_t));
+}
+
+static void page_init(unsigned char *page) {
+    page_header_t *h = page_header(page);
+    memset(h, 0, sizeof *h);
+    h->free_lower = sizeof(page_header_t);
+    h->free_upper = PAGE_BYTES;
+}
+
+// Returns the slot number, or -1 if the tuple and its slot do not fit.
+static int page_insert(unsigned char *page, const tuple_header_t *t, const char *first,
+                       const char *last) {
+    page_header_t *h = page_header(page);
+    size_t len = sizeof *t + t->first_len + t->last_len;
+    size_t stored = (len + TUPLE_ALIGN - 1) & ~(size_t)(TUPLE_ALIGN - 1);
+    unsigned char *dst;
+    slot_t *slot;
+
+    if ((size_t)h->free_upper - h->free_lower < stored + sizeof(slot_t)) return -1;
+    h->free_upper = (uint16_t)(h->free_upper - stored);
+    dst = page + h->free_upper;
+    memcpy(dst, t, sizeof *t);
+    memcpy(dst + sizeof *t, first, t->first_len);
+    memcpy(dst + sizeof *t + t->first_len, last, t->last_len);
+    slot = &page_slots(page)[h->nslots];
+    slot->offset = h->free_upper;
+    slot->length = (uint16_t)len;
+    h->free_lower = (uint16_t)(h->free_lower + sizeof(slot_t));
+    return h->nslots++;
+}
+
+static inline const tuple_header_t *page_tuple(unsigned char *page, unsigned slot) {
+    return (const tuple_header_t *)(page + page_slots(page)[slot].offset);
+}
+
+struct SlottedTable {
+    unsigned char *pages;
+    size_t npages;
+    size_t cap;
+    uint32_t *tids;  // row directory: record index -> tuple id
+};
+
+// Returns 0 on success, -1 if the table could not grow.
+static int table_insert(struct SlottedTable *tab, size_t row, const human1_t *h) {
+    tuple_header_t t = {
+        .height = h->height,
+        .age = h->age,
+        .first_len = (uint8_t)strlen(h->name.first),
+        .last_len = (uint8_t)strlen(h->name.last),
+        .first_initial = h->first_initial,
+    };
+    int slot = tab->npages ? page_insert(tab->pages + (tab->npages - 1) * PAGE_BYTES, &t,
+                                         h->name.first, h->name.last)
+                           : -1;
+    if (slot < 0) {
+        if (tab->npages == tab->cap) {
+            size_t cap = tab->cap ? tab->cap * 2 : 64;
+            unsigned char *p = realloc(tab->pages, cap * PAGE_BYTES);
+            if (!p) return -1;
+            tab->pages = p;
+            tab->cap = cap;
+        }
+        page_init(tab->pages + tab->npages++ * PAGE_BYTES);
+        slot = page_insert(tab->pages + (tab->npages - 1) * PAGE_BYTES, &t, h->name.first,
+                           h->name.last);
+    }
+    tab->tids[row] = (uint32_t)((tab->npages - 1) << TID_SLOT_BITS | (size_t)slot);
+    return 0;
+}
+
+static inline uint64_t hash_bytes(const char *s, size_t len) {
+    uint64_t h = 1469598103934665603u;
+    for (size_t i = 0; i < len; i++) h = (h ^ (unsigned char)s[i]) * 1099511628211u;
+    return h;
+}
+
+static inline uint64_t visit_row(const human1_t *h) {
+    return hash_bytes(h->name.first, strlen(h->name.first)) + (uint64_t)h->age;
+}
+
+static inline uint64_t visit_tuple(const tuple_header_t *t) {
+    return hash_bytes((const char *)(t + 1), t->first_len) + (uint64_t)t->age;
+}
+
+static uint64_t scan_rows(const human1_t *rows, size_t n) {
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) acc += visit_row(&rows[i]);
+    return acc;
+}
+
+static uint64_t scan_pages(const struct SlottedTable *tab) {
+    uint64_t acc = 0;
+    for (size_t p = 0; p < tab->npages; p++) {
+        unsigned char *page = tab->pages + p * PAGE_BYTES;
+        unsigned nslots = page_header(page)->nslots;
+        for (unsigned s = 0; s < nslots; s++) acc += visit_tuple(page_tuple(page, s));
+    }
+    return acc;
+}
+
+static uint64_t lookup_rows(const human1_t *rows, const uint32_t *idx, size_t n) {
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) acc += visit_row(&rows[idx[i]]);
+    return acc;
+}
+
+static uint64_t lookup_pages(const struct SlottedTable *tab, const uint32_t *idx, size_t n) {
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t tid = tab->tids[idx[i]];
+        unsigned char *page = tab->pages + (size_t)(tid >> TID_SLOT_BITS) * PAGE_BYTES;
+        acc += visit_tuple(page_tuple(page, tid & ((1u << TID_SLOT_BITS) - 1)));
+    }
+    return acc;
+}
+
+static char *copy_string(const char *s) {
+    size_t len = strlen(s) + 1;
+    char *p = malloc(len);
+    if (p) memcpy(p, s, len);
+    return p;
+}
+
+int bench_slotted(int argc, char **argv) {
+    size_t n = arg_count(argc, argv, 1, 1000000);
+    size_t nlookups = n;
+    human1_t *src = malloc(n * sizeof *src);
+    human1_t *rows = calloc(n, sizeof *rows);
+    uint32_t *idx = malloc(nlookups * sizeof *idx);
+    struct SlottedTable tab = {.tids = malloc(n * sizeof(uint32_t))};
+    struct FieldDesc page_fields[] = {
+        FIELD(page_header_t, lsn,        'L'),
+        FIELD(page_header_t, nslots,     'N'),
+        FIELD(page_header_t, free_lower, 'l'),
+        FIELD(page_header_t, free_upper, 'u'),
+        FIELD(page_header_t, flags,      'F'),
+    };
+    struct FieldDesc naive_fields[] = {
+        FIELD(tuple_header_naive_t, first_initial, 'I'),
+        FIELD(tuple_header_naive_t, height,        'H'),
+        FIELD(tuple_header_naive_t, first_len,     'f'),
+        FIELD(tuple_header_naive_t, age,           'A'),
+        FIELD(tuple_header_naive_t, last_len,      'l'),
+        FIELD(tuple_header_naive_t, flags,         'F'),
+    };
+    struct FieldDesc tuple_fields[] = {
+        FIELD(tuple_header_t, height,        'H'),
+        FIELD(tuple_header_t, age,           'A'),
+        FIELD(tuple_header_t, first_len,     'f'),
+        FIELD(tuple_header_t, last_len,      'l'),
+        FIELD(tuple_header_t, first_initial, 'I'),
+        FIELD(tuple_header_t, flags,         'F'),
+    };
+    uint64_t expect, acc, t0, dt;
+    uint64_t state = 0x2545f4914f6cdd1du;
+    size_t heap_bytes = 0, payload = 0, naive_pages;
+    int status = 1;
+
+    if (!src || !rows || !idx || !tab.tids) {
+        fprintf(stderr, "bench-slotted: cannot allocate %zu records\n", n);
+        goto out;
+    }
+    human_fill(src, n, 17);
+    for (size_t i = 0; i < nlookups; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        idx[i] = (uint32_t)(state % n);
+    }
+
+    visualize("PageHeader", sizeof(page_header_t), page_fields, NFIELDS(page_fields));
+    visualize("TupleHeaderNaive", sizeof(tuple_header_naive_t), naive_fields,
+              NFIELDS(naive_fields));
+    padding_report("TupleHeaderNaive", sizeof(tuple_header_naive_t), alignof(tuple_header_naive_t),
+                   naive_fields, NFIELDS(naive_fields));
+    visualize("TupleHeader", sizeof(tuple_header_t), tuple_fields, NFIELDS(tuple_fields));
+
+    // Insert: human1_t rows own malloc'd copies of both names.
+    t0 = now_ns();
+    for (size_t i = 0; i < n; i++) {
+        rows[i] = src[i];
+        rows[i].name.first = copy_string(src[i].name.first);
+        rows[i].name.last = copy_string(src[i].name.last);
+        if (!rows[i].name.first || !rows[i].name.last) {
+            fprintf(stderr, "bench-slotted: out of memory copying names\n");
+            goto out;
+        }
+    }
+    dt = now_ns() - t0;
+    for (size_t i = 0; i < n; i++) {
+        size_t lf = strlen(src[i].name.first), ll = strlen(src[i].name.last);
+        // malloc rounds each request up to 16 bytes plus an 8-byte header.
+        heap_bytes += ((lf + 1 + 8 + 15) & ~(size_t)15) + ((ll + 1 + 8 + 15) & ~(size_t)15);
+        payload += lf + ll;
+    }
+
+    printf("\n%zu records (ns/record):\n", n);
+    printf("%-30s %10s %10s %10s %8s\n", "layout", "insert", "scan", "lookup", "MiB");
+    expect = scan_rows(rows, n);
+    {
+        uint64_t ins = dt, scan, look, look_expect = lookup_rows(rows, idx, nlookups);
+        int ok;
+        t0 = now_ns();
+        acc = scan_rows(rows, n);
+        scan = now_ns() - t0;
+        t0 = now_ns();
+        acc += lookup_rows(rows, idx, nlookups);
+        look = now_ns() - t0;
+        printf("%-30s %10.1f %10.1f %10.1f %8.1f\n", "human1_t[] + heap names",
+               (double)ins / (double)n, (double)scan / (double)n, (double)look / (double)nlookups,
+               (double)(n * sizeof(human1_t) + heap_bytes) / (1024.0 * 1024.0));
+        bench_sink += acc;
+
+        t0 = now_ns();
+        for (size_t i = 0; i < n; i++) {
+            if (table_insert(&tab, i, &src[i]) != 0) {
+                fprintf(stderr, "bench-slotted: cannot grow page array\n");
+                goto out;
+            }
+        }
+        ins = now_ns() - t0;
+        t0 = now_ns();
+        acc = scan_pages(&tab);
+        scan = now_ns() - t0;
+        ok = acc == expect;
+        bench_sink += acc;
+        t0 = now_ns();
+        acc = lookup_pages(&tab, idx, nlookups);
+        look = now_ns() - t0;
+        ok = ok && acc == look_expect;
+        printf("%-30s %10.1f %10.1f %10.1f %8.1f%s\n", "slotted pages + row directory",
+               (double)ins / (double)n, (double)scan / (double)n, (double)look / (double)nlookups,
+               (double)(tab.npages * PAGE_BYTES + n * sizeof(uint32_t)) / (1024.0 * 1024.0),
+               ok ? "" : "  MISMATCH");
+        bench_sink += acc;
+    }
+
+    // Pages the naive header would need for the same tuples.
+    {
+        size_t used = 0, stride;
+        naive_pages = 1;
+        for (size_t i = 0; i < n; i++) {
+            size_t len = sizeof(tuple_header_naive_t) + strlen(src[i].name.first) +
+                         strlen(src[i].name.last);
+            stride = ((len + TUPLE_ALIGN - 1) & ~(size_t)(TUPLE_ALIGN - 1)) + sizeof(slot_t);
+            if (used + stride > PAGE_BYTES - sizeof(page_header_t)) {
+                naive_pages++;
+                used = 0;
+            }
+            used += stride;
+        }
+    }
+    printf("\nName payload %.1f MiB; %zu pages (%.1f tuples/page) with TupleHeader, "
+           "%zu pages with TupleHeaderNaive (+%.1f%%)\n",
+           (double)payload / (1024.0 * 1024.0), tab.npages, (double)n / (double)tab.npages,
+           naive_pages, 100.0 * ((double)naive_pages / (double)tab.npages - 1.0));
+    status = 0;
+
+out:
+    if (rows) {
+        for (size_t i = 0; i < n; i++) {
+            free(rows[i].name.first);
+            free(rows[i].name.last);
+        }
+    }
+    free(src);
+    free(rows);
+    free(idx);
+    free(tab.pages);
+    free(tab.tids);
+    return status;
+}
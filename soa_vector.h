@@ -0,0 +1,89 @@
+#ifndef SOA_VECTOR_H
+#define SOA_VECTOR_H
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "layout.h"
+
+// Column-wise growable vector of a struct type, generated from an X-macro
+// that lists the struct's members as X(type, member):
+//
+//   #define HUMAN1_MEMBERS(X) X(char, first_initial) X(int, age) X(double, height) X(name_t, name)
+//   SOA_VECTOR_DEFINE(human1, human1_t, HUMAN1_MEMBERS)
+//
+// defines soa_human1_t with one array per member (v.age[i]) and
+//   soa_human1_init(v)            empty vector
+//   soa_human1_reserve(v, cap)    0, or -1 if a column cannot grow
+//   soa_human1_push(v, &rec)      appends a record; 0 or -1
+//   soa_human1_get(v, i)          gathers record i into a T
+//   soa_human1_set(v, i, &rec)    scatters a T into record i
+//   soa_human1_columns(v, cols)   fills ColumnDescs for visualize_columns()
+//   soa_human1_free(v)
+// The list must name every member of T. Each listed type is checked against
+// the member it copies (_Generic), and the listed sizes against sizeof(T); a
+// member left out of the list is not detected and reads as zero in get().
+
+#define SOA_PTR_(type, member)  type *member;
+#define SOA_GROW_(type, member)                                  \
+    {                                                            \
+        type *grown = realloc(v->member, cap * sizeof(type));    \
+        if (!grown) return -1;                                   \
+        v->member = grown;                                       \
+    }
+#define SOA_STORE_(type, member) v->member[i] = rec->member;
+#define SOA_LOAD_(type, member)                                  \
+    _Static_assert(_Generic(out.member, type: 1, default: 0),    \
+                   "SoA column type differs from " #member);     \
+    out.member = v->member[i];
+#define SOA_DESC_(type, member) \
+    cols[n++] = (struct ColumnDesc){#member, #member[0], sizeof(type), v->member};
+#define SOA_FREE_(type, member) free(v->member);
+#define SOA_COUNT_(type, member) +1
+#define SOA_SIZE_(type, member) +sizeof(type)
+
+#define SOA_VECTOR_DEFINE(name, T, MEMBERS)                                              \
+    typedef struct {                                                                     \
+        size_t count;                                                                    \
+        size_t capacity;                                                                 \
+        MEMBERS(SOA_PTR_)                                                                \
+    } soa_##name##_t;                                                                    \
+    enum { soa_##name##_ncolumns = 0 MEMBERS(SOA_COUNT_) };                              \
+    _Static_assert(0 MEMBERS(SOA_SIZE_) <= sizeof(T), #name " lists more than " #T);     \
+    static inline void soa_##name##_init(soa_##name##_t *v) {                            \
+        memset(v, 0, sizeof *v);                                                         \
+    }                                                                                    \
+    static inline int soa_##name##_reserve(soa_##name##_t *v, size_t cap) {              \
+        if (cap <= v->capacity) return 0;                                                \
+        MEMBERS(SOA_GROW_)                                                               \
+        v->capacity = cap;                                                               \
+        return 0;                                                                        \
+    }                                                                                    \
+    static inline int soa_##name##_push(soa_##name##_t *v, const T *rec) {               \
+        size_t i = v->count;                                                             \
+        if (i == v->capacity && soa_##name##_reserve(v, i ? 2 * i : 16) != 0) return -1; \
+        MEMBERS(SOA_STORE_)                                                              \
+        v->count = i + 1;                                                                \
+        return 0;                                                                        \
+    }                                                                                    \
+    static inline T soa_##name##_get(const soa_##name##_t *v, size_t i) {                \
+        T out;                                                                           \
+        memset(&out, 0, sizeof out);                                                     \
+        MEMBERS(SOA_LOAD_)                                                               \
+        return out;                                                                      \
+    }                                                                                    \
+    static inline void soa_##name##_set(soa_##name##_t *v, size_t i, const T *rec) {     \
+        MEMBERS(SOA_STORE_)                                                              \
+    }                                                                                    \
+    static inline size_t soa_##name##_columns(const soa_##name##_t *v,                   \
+                                              struct ColumnDesc *cols) {                 \
+        size_t n = 0;                                                                    \
+        MEMBERS(SOA_DESC_)                                                               \
+        return n;                                                                        \
+    }                                                                                    \
+    static inline void soa_##name##_free(soa_##name##_t *v) {                            \
+        MEMBERS(SOA_FREE_)                                                               \
+        soa_##name##_init(v);                                                            \
+    }
+
+#endif
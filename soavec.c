@@ -0,0 +1,168 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "commands.h"
+#include "human.h"
+#include "layout.h"
+#include "soa_vector.h"
+
+// soa_vector.h against the row-wise growable array it would replace. Both
+// grow by doubling from 16 records; call sites keep pushing, getting and
+// setting whole human1_t records, while scans over one field use the
+// column directly.
+
+#define HUMAN1_MEMBERS(X) \
+    X(char, first_initial) X(int, age) X(double, height) X(name_t, name)
+
+SOA_VECTOR_DEFINE(human1, human1_t, HUMAN1_MEMBERS)
+
+typedef struct HumanVec {
+    size_t count;
+    size_t capacity;
+    human1_t *data;
+} human_vec_t;
+
+static int human_vec_push(human_vec_t *v, const human1_t *rec) {
+    if (v->count == v->capacity) {
+        size_t cap = v->capacity ? 2 * v->capacity : 16;
+        human1_t *grown = realloc(v->data, cap * sizeof *grown);
+        if (!grown) return -1;
+        v->data = grown;
+        v->capacity = cap;
+    }
+    v->data[v->count++] = *rec;
+    return 0;
+}
+
+static uint64_t sum_age_aos(const human_vec_t *v) {
+    uint64_t acc = 0;
+    for (size_t i = 0; i < v->count; i++) acc += (uint64_t)v->data[i].age;
+    return acc;
+}
+
+static uint64_t sum_age_soa(const soa_human1_t *v) {
+    uint64_t acc = 0;
+    for (size_t i = 0; i < v->count; i++) acc += (uint64_t)v->age[i];
+    return acc;
+}
+
+static void grow_aos(human_vec_t *v) {
+    for (size_t i = 0; i < v->count; i++) v->data[i].height += 0.01;
+}
+
+static void grow_soa(soa_human1_t *v) {
+    for (size_t i = 0; i < v->count; i++) v->height[i] += 0.01;
+}
+
+static uint64_t record_key(const human1_t *h) {
+    return (uint64_t)h->age * 31u + (uint64_t)(unsigned char)h->first_initial +
+           (uint64_t)(h->height * 100.0) + (uint64_t)(uintptr_t)h->name.last;
+}
+
+static uint64_t get_random_aos(const human_vec_t *v, const uint32_t *idx, size_t n) {
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) acc += record_key(&v->data[idx[i]]);
+    return acc;
+}
+
+static uint64_t get_random_soa(const soa_human1_t *v, const uint32_t *idx, size_t n) {
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) {
+        human1_t h = soa_human1_get(v, idx[i]);
+        acc += record_key(&h);
+    }
+    return acc;
+}
+
+int bench_soavec(int argc, char **argv) {
+    size_t n = arg_count(argc, argv, 1, 4000000);
+    human1_t *src = malloc(n * sizeof *src);
+    uint32_t *idx = malloc(n * sizeof *idx);
+    human_vec_t aos = {0, 0, NULL};
+    soa_human1_t soa;
+    struct ColumnDesc cols[soa_human1_ncolumns];
+    struct FieldDesc human1_fields[] = {
+        FIELD(human1_t, first_initial, 'F'),
+        FIELD(human1_t, age,           'A'),
+        FIELD(human1_t, height,        'H'),
+        FIELD(human1_t, name,          'N'),
+    };
+    uint64_t state = 0x6a09e667f3bcc909u, t0, ta, ts, a, s;
+    int status = 1;
+
+    soa_human1_init(&soa);
+    if (!src || !idx) {
+        fprintf(stderr, "bench-soavec: cannot allocate %zu records\n", n);
+        goto out;
+    }
+    human_fill(src, n, 29);
+    for (size_t i = 0; i < n; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        idx[i] = (uint32_t)(state % n);
+    }
+
+    printf("%zu records (ns/record):\n", n);
+    printf("%-24s %10s %10s\n", "operation", "human1_t[]", "soa_vector");
+
+    t0 = now_ns();
+    for (size_t i = 0; i < n; i++) {
+        if (human_vec_push(&aos, &src[i]) != 0) goto oom;
+    }
+    ta = now_ns() - t0;
+    t0 = now_ns();
+    for (size_t i = 0; i < n; i++) {
+        if (soa_human1_push(&soa, &src[i]) != 0) goto oom;
+    }
+    ts = now_ns() - t0;
+    printf("%-24s %10.2f %10.2f\n", "push_back", (double)ta / (double)n, (double)ts / (double)n);
+
+    t0 = now_ns();
+    a = sum_age_aos(&aos);
+    ta = now_ns() - t0;
+    t0 = now_ns();
+    s = sum_age_soa(&soa);
+    ts = now_ns() - t0;
+    printf("%-24s %10.2f %10.2f%s\n", "sum age", (double)ta / (double)n, (double)ts / (double)n,
+           a == s ? "" : "  MISMATCH");
+    bench_sink += a + s;
+
+    t0 = now_ns();
+    grow_aos(&aos);
+    ta = now_ns() - t0;
+    t0 = now_ns();
+    grow_soa(&soa);
+    ts = now_ns() - t0;
+    printf("%-24s %10.2f %10.2f\n", "height += 0.01", (double)ta / (double)n,
+           (double)ts / (double)n);
+
+    t0 = now_ns();
+    a = get_random_aos(&aos, idx, n);
+    ta = now_ns() - t0;
+    t0 = now_ns();
+    s = get_random_soa(&soa, idx, n);
+    ts = now_ns() - t0;
+    printf("%-24s %10.2f %10.2f%s\n", "get whole record (rand)", (double)ta / (double)n,
+           (double)ts / (double)n, a == s ? "" : "  MISMATCH");
+    bench_sink += a + s;
+
+    visualize("human1_t[] element", sizeof(human1_t), human1_fields, NFIELDS(human1_fields));
+    visualize_columns("soa_human1_t", cols, soa_human1_columns(&soa, cols), soa.count,
+                      soa.capacity);
+    status = 0;
+    goto out;
+
+oom:
+    fprintf(stderr, "bench-soavec: out of memory while pushing\n");
+out:
+    free(src);
+    free(idx);
+    free(aos.data);
+    soa_human1_free(&soa);
+    return status;
+}
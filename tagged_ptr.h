@@ -0,0 +1,58 @@
+#ifndef TAGGED_PTR_H
+#define TAGGED_PTR_H
+
+#include <stdint.h>
+
+// A pointer with small fields stored in the bits the address does not use.
+// User-space addresses on x86-64 (4-level paging) and AArch64 (48-bit VA)
+// are below 2^47, so the top 16 bits of a pointer are zero; a pointer to
+// objects aligned to 2^k bytes also has k zero low bits.
+//
+//   bit 63        48 47                          k k-1      0
+//       [ high tag  ][          address           ][ low tag ]
+//
+// tp_fits() checks both assumptions for a given pointer; tagging a pointer
+// that fails it loses address bits. Loads must untag with tp_ptr() first,
+// which costs one AND (and a shift for the high tag).
+
+_Static_assert(sizeof(void *) == 8, "tagged pointers need 64-bit pointers");
+
+#define TP_ADDR_BITS 48
+#define TP_HIGH_BITS (64 - TP_ADDR_BITS)
+#define TP_ADDR_MASK ((UINT64_C(1) << TP_ADDR_BITS) - 1)
+
+typedef uint64_t tagged_ptr_t;
+
+static inline uint64_t tp_low_mask_(unsigned low_bits) {
+    return (UINT64_C(1) << low_bits) - 1;
+}
+
+// Whether p can carry a high tag and `low_bits` bits of low tag.
+static inline int tp_fits(const void *p, unsigned low_bits) {
+    uint64_t a = (uint64_t)(uintptr_t)p;
+    return (a & ~TP_ADDR_MASK) == 0 && (a & tp_low_mask_(low_bits)) == 0;
+}
+
+static inline tagged_ptr_t tp_make(const void *p, uint16_t high, unsigned low,
+                                   unsigned low_bits) {
+    return (uint64_t)(uintptr_t)p | (uint64_t)high << TP_ADDR_BITS |
+           ((uint64_t)low & tp_low_mask_(low_bits));
+}
+
+static inline void *tp_ptr(tagged_ptr_t t, unsigned low_bits) {
+    return (void *)(uintptr_t)(t & TP_ADDR_MASK & ~tp_low_mask_(low_bits));
+}
+
+static inline uint16_t tp_high(tagged_ptr_t t) {
+    return (uint16_t)(t >> TP_ADDR_BITS);
+}
+
+static inline unsigned tp_low(tagged_ptr_t t, unsigned low_bits) {
+    return (unsigned)(t & tp_low_mask_(low_bits));
+}
+
+static inline tagged_ptr_t tp_with_high(tagged_ptr_t t, uint16_t high) {
+    return (t & TP_ADDR_MASK) | (uint64_t)high << TP_ADDR_BITS;
+}
+
+#endif
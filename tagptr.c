@@ -0,0 +1,209 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "commands.h"
+#include "human.h"
+#include "layout.h"
+#include "tagged_ptr.h"
+
+// Small fields moved into the spare high bits of the name pointers
+// (tagged_ptr.h). first_initial alone frees 1 byte of human2_t, which only
+// turns into tail padding; moving age into name.last as well drops the
+// record from 32 to 24 bytes. The name strings are not aligned, so the low
+// bits stay unused here.
+
+typedef struct HumanTagInitial {
+    tagged_ptr_t first;  // name.first, first_initial in bits 48-55
+    char        *last;
+    double       height;
+    int          age;
+} human_tag_initial_t;
+
+typedef struct HumanTagBoth {
+    tagged_ptr_t first;  // name.first, first_initial in bits 48-55
+    tagged_ptr_t last;   // name.last, age in bits 48-63
+    double       height;
+} human_tag_both_t;
+
+static uint64_t small_human2(const human2_t *r, size_t n) {
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) acc += (uint64_t)r[i].age + (r[i].first_initial == 'A');
+    return acc;
+}
+
+static uint64_t small_initial(const human_tag_initial_t *r, size_t n) {
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) acc += (uint64_t)r[i].age + (tp_high(r[i].first) == 'A');
+    return acc;
+}
+
+static uint64_t small_both(const human_tag_both_t *r, size_t n) {
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) acc += tp_high(r[i].last) + (tp_high(r[i].first) == 'A');
+    return acc;
+}
+
+static uint64_t names_human2(const human2_t *r, size_t n) {
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) {
+        acc += (unsigned char)r[i].name.first[1] + (unsigned char)r[i].name.last[1];
+    }
+    return acc;
+}
+
+static uint64_t names_initial(const human_tag_initial_t *r, size_t n) {
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) {
+        acc += (unsigned char)((const char *)tp_ptr(r[i].first, 0))[1] +
+               (unsigned char)r[i].last[1];
+    }
+    return acc;
+}
+
+static uint64_t names_both(const human_tag_both_t *r, size_t n) {
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) {
+        acc += (unsigned char)((const char *)tp_ptr(r[i].first, 0))[1] +
+               (unsigned char)((const char *)tp_ptr(r[i].last, 0))[1];
+    }
+    return acc;
+}
+
+static void birthday_human2(human2_t *r, size_t n) {
+    for (size_t i = 0; i < n; i++) r[i].age++;
+}
+
+static void birthday_initial(human_tag_initial_t *r, size_t n) {
+    for (size_t i = 0; i < n; i++) r[i].age++;
+}
+
+static void birthday_both(human_tag_both_t *r, size_t n) {
+    for (size_t i = 0; i < n; i++) r[i].last = tp_with_high(r[i].last, tp_high(r[i].last) + 1);
+}
+
+int bench_tagged(int argc, char **argv) {
+    size_t n = arg_count(argc, argv, 1, 4000000);
+    human1_t *src = malloc(n * sizeof *src);
+    human2_t *plain = malloc(n * sizeof *plain);
+    human_tag_initial_t *initial = malloc(n * sizeof *initial);
+    human_tag_both_t *both = malloc(n * sizeof *both);
+    struct FieldDesc human2_fields[] = {
+        FIELD(human2_t, name,          'N'),
+        FIELD(human2_t, height,        'H'),
+        FIELD(human2_t, age,           'A'),
+        FIELD(human2_t, first_initial, 'F'),
+    };
+    struct FieldDesc initial_fields[] = {
+        FIELD(human_tag_initial_t, first,  'f'),
+        FIELD(human_tag_initial_t, last,   'N'),
+        FIELD(human_tag_initial_t, height, 'H'),
+        FIELD(human_tag_initial_t, age,    'A'),
+    };
+    struct FieldDesc both_fields[] = {
+        FIELD(human_tag_both_t, first,  'f'),
+        FIELD(human_tag_both_t, last,   'a'),
+        FIELD(human_tag_both_t, height, 'H'),
+    };
+    static const struct BitRange first_bits[] = {
+        {"name.first", 'N', 0, TP_ADDR_BITS},
+        {"first_initial", 'F', TP_ADDR_BITS, 8},
+    };
+    static const struct BitRange last_bits[] = {
+        {"name.last", 'N', 0, TP_ADDR_BITS},
+        {"age", 'A', TP_ADDR_BITS, TP_HIGH_BITS},
+    };
+    struct {
+        const char *name;
+        size_t size;
+        uint64_t small, names, birthday;
+    } rows[3] = {
+        {"human2_t", sizeof(human2_t), 0, 0, 0},
+        {"initial in first", sizeof(human_tag_initial_t), 0, 0, 0},
+        {"initial + age", sizeof(human_tag_both_t), 0, 0, 0},
+    };
+    uint64_t t0, small[3], names[3];
+    int status = 1;
+
+    visualize("human2_t", sizeof(human2_t), human2_fields, NFIELDS(human2_fields));
+    visualize("HumanTagInitial (f = tagged name.first)", sizeof(human_tag_initial_t),
+              initial_fields, NFIELDS(initial_fields));
+    visualize_bits("HumanTagInitial.first", 64, first_bits, NFIELDS(first_bits));
+    visualize("HumanTagBoth (f, a = tagged name.first, name.last)", sizeof(human_tag_both_t),
+              both_fields, NFIELDS(both_fields));
+    visualize_bits("HumanTagBoth.last", 64, last_bits, NFIELDS(last_bits));
+
+    if (!src || !plain || !initial || !both) {
+        fprintf(stderr, "bench-tagged: cannot allocate %zu records\n", n);
+        goto out;
+    }
+    human_fill(src, n, 47);
+    human_to_human2(plain, src, n);
+    for (size_t i = 0; i < n; i++) {
+        if (!tp_fits(src[i].name.first, 0) || !tp_fits(src[i].name.last, 0)) {
+            fprintf(stderr, "bench-tagged: %p is not a 48-bit user address\n",
+                    (void *)src[i].name.first);
+            goto out;
+        }
+        initial[i].first = tp_make(src[i].name.first, (unsigned char)src[i].first_initial, 0, 0);
+        initial[i].last = src[i].name.last;
+        initial[i].height = src[i].height;
+        initial[i].age = src[i].age;
+        both[i].first = initial[i].first;
+        both[i].last = tp_make(src[i].name.last, (uint16_t)src[i].age, 0, 0);
+        both[i].height = src[i].height;
+    }
+
+    t0 = now_ns();
+    small[0] = small_human2(plain, n);
+    rows[0].small = now_ns() - t0;
+    t0 = now_ns();
+    small[1] = small_initial(initial, n);
+    rows[1].small = now_ns() - t0;
+    t0 = now_ns();
+    small[2] = small_both(both, n);
+    rows[2].small = now_ns() - t0;
+
+    t0 = now_ns();
+    names[0] = names_human2(plain, n);
+    rows[0].names = now_ns() - t0;
+    t0 = now_ns();
+    names[1] = names_initial(initial, n);
+    rows[1].names = now_ns() - t0;
+    t0 = now_ns();
+    names[2] = names_both(both, n);
+    rows[2].names = now_ns() - t0;
+
+    t0 = now_ns();
+    birthday_human2(plain, n);
+    rows[0].birthday = now_ns() - t0;
+    t0 = now_ns();
+    birthday_initial(initial, n);
+    rows[1].birthday = now_ns() - t0;
+    t0 = now_ns();
+    birthday_both(both, n);
+    rows[2].birthday = now_ns() - t0;
+    bench_sink += small[0] + small[1] + small[2] + names[0] + names[1] + names[2];
+
+    printf("\n%zu records (ns/record):\n", n);
+    printf("%-18s %6s %9s %12s %12s %10s\n", "layout", "bytes", "MiB", "age+initial",
+           "name chars", "age += 1");
+    for (size_t l = 0; l < 3; l++) {
+        int ok = small[l] == small[0] && names[l] == names[0];
+        if (l == 2 && n) ok = ok && tp_high(both[n - 1].last) == (uint16_t)plain[n - 1].age;
+        printf("%-18s %6zu %9.1f %12.2f %12.2f %10.2f%s\n", rows[l].name, rows[l].size,
+               (double)(n * rows[l].size) / (1024.0 * 1024.0), (double)rows[l].small / (double)n,
+               (double)rows[l].names / (double)n, (double)rows[l].birthday / (double)n,
+               ok ? "" : "  MISMATCH");
+    }
+    status = 0;
+
+out:
+    free(src);
+    free(plain);
+    free(initial);
+    free(both);
+    return status;
+}
@@ -0,0 +1,599 @@
+#define _GNU_SOURCE
+
+#include <inttypes.h>
+#include <linux/hw_breakpoint.h>
+#include <linux/perf_event.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "commands.h"
+#include "human.h"
+
+// Auto-vectorization per layout. Writes a standalone C file with three loops
+// (sum of age, filter on height and age, age += 1) over every layout, builds
+// it with each compiler found on PATH with its vectorization remarks enabled,
+// matches the remarks to the loops by line and runs the program for
+// per-element timings.
+
+enum VecOp { OP_SUM, OP_FILTER, OP_UPDATE, OP_COUNT };
+
+static const char *op_name[OP_COUNT] = {"sum", "filter", "update"};
+
+// One layout of the generated program. The record types are emitted from
+// these definitions and checked against sizeof() in this binary, so the
+// generated loops run over the same layouts as the rest of the tool.
+struct VecLayout {
+    const char *name;
+    const char *definition;  // NULL for the SoA columns
+    size_t size;
+    const char *tall;        // filter predicate on a[i]
+    const char *set_height;  // statement setting the height of a[i]
+};
+
+static const struct VecLayout vec_layouts[] = {
+    {"human1_t",
+     "typedef struct Human1 { char first_initial; int age; double height; name_t name; } human1_t;",
+     sizeof(human1_t), "a[i].height > 1.8", "a[i].height = 1.40 + (double)(i % 71) / 100.0;"},
+    {"human2_t",
+     "typedef struct Human2 { name_t name; double height; int age; char first_initial; } human2_t;",
+     sizeof(human2_t), "a[i].height > 1.8", "a[i].height = 1.40 + (double)(i % 71) / 100.0;"},
+    {"human_worst_t",
+     "typedef struct HumanWorst { char first_initial; double height; int age; name_t name; } "
+     "human_worst_t;",
+     sizeof(human_worst_t), "a[i].height > 1.8",
+     "a[i].height = 1.40 + (double)(i % 71) / 100.0;"},
+    {"human_slim_t",
+     "typedef struct HumanSlim { uint16_t height_cm; uint8_t age; char first_initial; "
+     "uint32_t name_id; } human_slim_t;",
+     sizeof(human_slim_t), "a[i].height_cm > 180", "a[i].height_cm = (uint16_t)(140 + i % 71);"},
+    {"SoA columns", NULL, 0, "height[i] > 1.8", NULL},
+};
+
+#define VEC_NLAYOUTS (sizeof vec_layouts / sizeof vec_layouts[0])
+
+struct VecCompiler {
+    const char *cc;
+    const char *remarks;  // flags that print vectorization remarks to stderr
+};
+
+static const struct VecCompiler vec_compilers[] = {
+    {"gcc", "-fopt-info-vec-optimized -fopt-info-vec-missed"},
+    {"clang", "-Rpass=loop-vectorize -Rpass-missed=loop-vectorize -Rpass-analysis=loop-vectorize"},
+};
+
+struct VecLoop {
+    int fn_line;    // line of the function header
+    int loop_line;  // line of the for statement
+    char how[96];   // vector width, or why the loop was not vectorized
+    int vectorized;
+    double ns;      // per element, negative if the program did not report it
+};
+
+struct Gen {
+    FILE *f;
+    int line;  // number of the next line written
+};
+
+static void emit(struct Gen *g, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    vfprintf(g->f, fmt, ap);
+    va_end(ap);
+    fputc('\n', g->f);
+    g->line++;
+}
+
+static void emit_loops(struct Gen *g, size_t k, struct VecLoop *loops) {
+    const struct VecLayout *L = &vec_layouts[k];
+    char params[128], wparams[128];
+    const char *age = L->definition ? "a[i].age" : "age[i]";
+    struct VecLoop *lp = &loops[k * OP_COUNT];
+
+    if (L->definition) {
+        snprintf(params, sizeof params, "const %s *restrict a", L->name);
+        snprintf(wparams, sizeof wparams, "%s *restrict a", L->name);
+    } else {
+        snprintf(params, sizeof params, "const int *restrict age, const double *restrict height");
+        snprintf(wparams, sizeof wparams, "int *restrict age");
+    }
+
+    lp[OP_SUM].fn_line = g->line;
+    emit(g, "__attribute__((noinline)) int64_t sum_%zu(%s, size_t n) {", k, params);
+    emit(g, "    int64_t s = 0;");
+    lp[OP_SUM].loop_line = g->line;
+    emit(g, "    for (size_t i = 0; i < n; i++) s += %s;", age);
+    emit(g, "    return s;");
+    emit(g, "}");
+
+    lp[OP_FILTER].fn_line = g->line;
+    emit(g, "__attribute__((noinline)) int64_t filter_%zu(%s, size_t n) {", k, params);
+    emit(g, "    int64_t c = 0;");
+    lp[OP_FILTER].loop_line = g->line;
+    emit(g, "    for (size_t i = 0; i < n; i++) c += (%s) & (%s < 30);", L->tall, age);
+    emit(g, "    return c;");
+    emit(g, "}");
+
+    lp[OP_UPDATE].fn_line = g->line;
+    emit(g, "__attribute__((noinline)) void update_%zu(%s, size_t n) {", k, wparams);
+    lp[OP_UPDATE].loop_line = g->line;
+    emit(g, "    for (size_t i = 0; i < n; i++) %s += 1;", age);
+    emit(g, "}");
+}
+
+static void emit_data(struct Gen *g, size_t k) {
+    const struct VecLayout *L = &vec_layouts[k];
+    if (L->definition) {
+        emit(g, "static %s *d%zu;", L->name, k);
+        emit(g, "static int64_t run_sum_%zu(size_t n) { return sum_%zu(d%zu, n); }", k, k, k);
+        emit(g, "static int64_t run_filter_%zu(size_t n) { return filter_%zu(d%zu, n); }", k, k, k);
+        emit(g, "static int64_t run_update_%zu(size_t n) { update_%zu(d%zu, n); return 0; }", k,
+             k, k);
+    } else {
+        emit(g, "static int *d%zu_age;", k);
+        emit(g, "static double *d%zu_height;", k);
+        emit(g, "static int64_t run_sum_%zu(size_t n) {", k);
+        emit(g, "    return sum_%zu(d%zu_age, d%zu_height, n);", k, k, k);
+        emit(g, "}");
+        emit(g, "static int64_t run_filter_%zu(size_t n) {", k);
+        emit(g, "    return filter_%zu(d%zu_age, d%zu_height, n);", k, k, k);
+        emit(g, "}");
+        emit(g, "static int64_t run_update_%zu(size_t n) { update_%zu(d%zu_age, n); return 0; }", k,
+             k, k);
+    }
+}
+
+static void emit_alloc(struct Gen *g, size_t k) {
+    const struct VecLayout *L = &vec_layouts[k];
+    if (L->definition) {
+        emit(g, "    d%zu = calloc(n, sizeof *d%zu);", k, k);
+        emit(g, "    if (!d%zu) return 1;", k);
+        emit(g, "    for (size_t i = 0; i < n; i++) {");
+        emit(g, "        %s *a = d%zu;", L->name, k);
+        emit(g, "        a[i].age = (int)(i * 7 %% 100);");
+        emit(g, "        %s", L->set_height);
+        emit(g, "    }");
+    } else {
+        emit(g, "    d%zu_age = calloc(n, sizeof *d%zu_age);", k, k);
+        emit(g, "    d%zu_height = calloc(n, sizeof *d%zu_height);", k, k);
+        emit(g, "    if (!d%zu_age || !d%zu_height) return 1;", k, k);
+        emit(g, "    for (size_t i = 0; i < n; i++) {");
+        emit(g, "        d%zu_age[i] = (int)(i * 7 %% 100);", k);
+        emit(g, "        d%zu_height[i] = 1.40 + (double)(i %% 71) / 100.0;", k);
+        emit(g, "    }");
+    }
+}
+
+// Returns 0 on success, -1 if the file cannot be written.
+static int write_program(const char *path, struct VecLoop *loops) {
+    struct Gen g = {fopen(path, "w"), 1};
+    if (!g.f) return -1;
+
+    emit(&g, "// Generated by memory_padding vec-report.");
+    emit(&g, "#define _POSIX_C_SOURCE 200809L");
+    emit(&g, "#include <stdint.h>");
+    emit(&g, "#include <stdio.h>");
+    emit(&g, "#include <stdlib.h>");
+    emit(&g, "#include <time.h>");
+    emit(&g, "typedef struct Name { char *first; char *last; } name_t;");
+    for (size_t k = 0; k < VEC_NLAYOUTS; k++) {
+        if (!vec_layouts[k].definition) continue;
+        emit(&g, "%s", vec_layouts[k].definition);
+        emit(&g, "_Static_assert(sizeof(%s) == %zu, \"layout differs from human.h\");",
+             vec_layouts[k].name, vec_layouts[k].size);
+    }
+    for (size_t k = 0; k < VEC_NLAYOUTS; k++) emit_loops(&g, k, loops);
+    for (size_t k = 0; k < VEC_NLAYOUTS; k++) emit_data(&g, k);
+
+    emit(&g, "static double best_ns(int64_t (*fn)(size_t), size_t n, volatile int64_t *sink) {");
+    emit(&g, "    double best = 0;");
+    emit(&g, "    for (int r = 0; r < 5; r++) {");
+    emit(&g, "        struct timespec t0, t1;");
+    emit(&g, "        clock_gettime(CLOCK_MONOTONIC, &t0);");
+    emit(&g, "        *sink += fn(n);");
+    emit(&g, "        clock_gettime(CLOCK_MONOTONIC, &t1);");
+    emit(&g, "        double ns = (double)(t1.tv_sec - t0.tv_sec) * 1e9 +");
+    emit(&g, "                    (double)(t1.tv_nsec - t0.tv_nsec);");
+    emit(&g, "        if (r == 0 || ns < best) best = ns;");
+    emit(&g, "    }");
+    emit(&g, "    return best / (double)n;");
+    emit(&g, "}");
+    emit(&g, "static int64_t (*const runs[])(size_t) = {");
+    for (size_t k = 0; k < VEC_NLAYOUTS; k++) {
+        emit(&g, "    run_sum_%zu, run_filter_%zu, run_update_%zu,", k, k, k);
+    }
+    emit(&g, "};");
+    emit(&g, "int main(int argc, char **argv) {");
+    emit(&g, "    size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 1000000;");
+    emit(&g, "    size_t nruns = sizeof runs / sizeof runs[0];");
+    emit(&g, "    volatile int64_t sink = 0;");
+    emit(&g, "    if (n == 0) n = 1;");
+    for (size_t k = 0; k < VEC_NLAYOUTS; k++) emit_alloc(&g, k);
+    emit(&g, "    if (argc > 2) {");
+    emit(&g, "        size_t r = strtoull(argv[2], NULL, 10);  // one untimed pass of one loop");
+    emit(&g, "        if (r < nruns) sink += runs[r](n);");
+    emit(&g, "        return 0;");
+    emit(&g, "    }");
+    emit(&g, "    for (size_t r = 0; r < nruns; r++) {");
+    emit(&g, "        printf(\"%%zu %%d %%.4f\\n\", r / %d, (int)(r %% %d), best_ns(runs[r], n, &sink));",
+         OP_COUNT, OP_COUNT);
+    emit(&g, "    }");
+    emit(&g, "    return 0;");
+    emit(&g, "}");
+    return fclose(g.f) == 0 ? 0 : -1;
+}
+
+static int compiler_available(const char *cc) {
+    char cmd[256];
+    snprintf(cmd, sizeof cmd, "%s --version >/dev/null 2>&1", cc);
+    return system(cmd) == 0;
+}
+
+// gcc:   vecloops.c:LINE:COL: optimized: loop vectorized using 32 byte vectors
+//        vecloops.c:LINE:COL: missed: not vectorized: <reason>
+// clang: vecloops.c:LINE:COL: remark: vectorized loop (vectorization width: 8, ...)
+//        vecloops.c:LINE:COL: remark: loop not vectorized: <reason>
+static void parse_remarks(const char *path, struct VecLoop *loops, size_t nloops) {
+    FILE *f = fopen(path, "r");
+    char line[1024];
+    if (!f) return;
+    while (fgets(line, sizeof line, f)) {
+        const char *p = strstr(line, "vecloops.c:");
+        const char *msg;
+        int at;
+        if (!p || sscanf(p, "vecloops.c:%d:", &at) != 1) continue;
+        line[strcspn(line, "\n")] = '\0';
+        for (size_t i = 0; i < nloops; i++) {
+            struct VecLoop *lp = &loops[i];
+            size_t used = strlen(lp->how);
+            unsigned bytes;
+            if (at < lp->fn_line || at > lp->loop_line) continue;
+            if ((msg = strstr(line, "loop vectorized using ")) &&
+                sscanf(msg, "loop vectorized using %u byte vectors", &bytes) == 1) {
+                if (!lp->vectorized) used = 0;
+                snprintf(lp->how + used, sizeof lp->how - used, "%s%uB", used ? "+" : "", bytes);
+                lp->vectorized = 1;
+            } else if ((msg = strstr(line, "vectorized loop ("))) {
+                snprintf(lp->how, sizeof lp->how, "%s", msg + strlen("vectorized loop "));
+                lp->vectorized = 1;
+            } else if (!lp->vectorized && !lp->how[0] && (msg = strstr(line, "not vectorized: "))) {
+                snprintf(lp->how, sizeof lp->how, "%s", msg + strlen("not vectorized: "));
+            }
+        }
+    }
+    fclose(f);
+}
+
+static void run_program(const char *bin, size_t n, struct VecLoop *loops, size_t nloops) {
+    char cmd[4200];
+    FILE *p;
+    size_t k;
+    int op;
+    double ns;
+
+    snprintf(cmd, sizeof cmd, "'%s' %zu", bin, n);
+    if (!(p = popen(cmd, "r"))) return;
+    while (fscanf(p, "%zu %d %lf", &k, &op, &ns) == 3) {
+        if (k < VEC_NLAYOUTS && op >= 0 && op < OP_COUNT && k * OP_COUNT + (size_t)op < nloops) {
+            loops[k * OP_COUNT + (size_t)op].ns = ns;
+        }
+    }
+    pclose(p);
+}
+
+// Instruction mix of the generated loops. objdump gives the static body of
+// every loop (the instructions between a backward branch and its target);
+// how often each body runs is counted with a hardware execute breakpoint on
+// its branch while the program makes one pass over VEC_COUNT_N elements.
+// Together they give dynamic instructions, loads and shuffles per element
+// and the elements each iteration of the hottest loop handles.
+
+#define VEC_COUNT_N   4096
+#define MAX_INSNS     1024
+#define MAX_BRANCHES  4  // x86 has four debug address registers
+
+struct Insn {
+    uint64_t addr;
+    uint64_t target;  // branch target, 0 if not a direct branch
+    unsigned char load, store, shuffle;
+};
+
+struct FnCode {
+    char name[32];
+    size_t ninsns;
+    struct Insn insns[MAX_INSNS];
+};
+
+struct LoopMix {
+    double insns, loads, shuffles;  // per element
+    double elems_per_iter;          // of the hottest loop
+};
+
+static int has_prefix(const char *s, const char *prefix) {
+    return strncmp(s, prefix, strlen(prefix)) == 0;
+}
+
+static int is_shuffle(const char *m) {
+    static const char *const ops[] = {
+        "pshuf", "perm", "shufp", "punpck", "unpck", "insert", "extract", "palignr", "pack",
+        "pmovzx", "pmovsx", "broadcast", "pbroadcast", "blend", "pblend", "movhlps", "movlhps",
+        "pinsr", "pextr", "compress", "expand", "pcompress", "pexpand",
+    };
+    if (m[0] == 'v') m++;
+    for (size_t i = 0; i < sizeof ops / sizeof ops[0]; i++) {
+        if (has_prefix(m, ops[i])) return 1;
+    }
+    return 0;
+}
+
+// AT&T syntax: a memory operand contains '(' and the destination is last.
+static void classify(struct Insn *in, const char *mnem, const char *operands) {
+    const char *paren = strchr(operands, '('), *last = operands;
+    int depth = 0;
+
+    in->shuffle = (unsigned char)is_shuffle(mnem);
+    if (!paren || has_prefix(mnem, "lea") || has_prefix(mnem, "nop") ||
+        has_prefix(mnem, "prefetch")) {
+        return;
+    }
+    for (const char *p = operands; *p; p++) {
+        if (*p == '(') depth++;
+        if (*p == ')') depth--;
+        if (*p == ',' && depth == 0) last = p + 1;
+    }
+    if (!strchr(last, '(') || has_prefix(mnem, "cmp") || has_prefix(mnem, "test") ||
+        has_prefix(mnem, "vcmp") || has_prefix(mnem, "vptest") || has_prefix(mnem, "bt")) {
+        in->load = 1;
+    } else if (has_prefix(mnem, "mov") || has_prefix(mnem, "vmov") || has_prefix(mnem, "vpmov") ||
+               has_prefix(mnem, "vmaskmov") || has_prefix(mnem, "vpmaskmov") ||
+               has_prefix(mnem, "vextract") || has_prefix(mnem, "vpextr") ||
+               has_prefix(mnem, "pextr") || has_prefix(mnem, "vpscatter") ||
+               has_prefix(mnem, "vscatter") || has_prefix(mnem, "set") ||
+               has_prefix(mnem, "stos")) {
+        in->store = 1;
+    } else {
+        in->load = in->store = 1;  // read-modify-write
+    }
+}
+
+// Disassembles the loop functions (sum_K, filter_K, update_K) of `bin`.
+// Returns the number found, or -1 if objdump cannot be run.
+static int disassemble(const char *bin, struct FnCode *fns, size_t nfns) {
+    char cmd[4200], line[512];
+    struct FnCode *cur = NULL;
+    FILE *p;
+    int found = 0;
+
+    snprintf(cmd, sizeof cmd, "objdump -d --no-show-raw-insn '%s' 2>/dev/null", bin);
+    if (!(p = popen(cmd, "r"))) return -1;
+    while (fgets(line, sizeof line, p)) {
+        char name[64], mnem[32], operands[256];
+        uint64_t addr;
+        const char *text;
+        struct Insn *in;
+
+        if (sscanf(line, "%" SCNx64 " <%63[^>]>:", &addr, name) == 2) {
+            cur = NULL;
+            for (size_t i = 0; i < nfns; i++) {
+                if (strcmp(fns[i].name, name) == 0) {
+                    cur = &fns[i];
+                    found++;
+                }
+            }
+            continue;
+        }
+        if (!cur || cur->ninsns == MAX_INSNS || sscanf(line, " %" SCNx64 ":", &addr) != 1 ||
+            !(text = strchr(line, '\t'))) {
+            continue;
+        }
+        operands[0] = '\0';
+        if (sscanf(text, " %31s %255[^\n]", mnem, operands) < 1) continue;
+        // Skip prefixes objdump prints as separate words.
+        while (strcmp(mnem, "notrack") == 0 || strcmp(mnem, "bnd") == 0 ||
+               strcmp(mnem, "lock") == 0 || strcmp(mnem, "rep") == 0 ||
+               strcmp(mnem, "data16") == 0 || strcmp(mnem, "cs") == 0) {
+            char rest[256];
+            snprintf(rest, sizeof rest, "%s", operands);
+            operands[0] = '\0';
+            if (sscanf(rest, "%31s %255[^\n]", mnem, operands) < 1) break;
+        }
+        in = &cur->insns[cur->ninsns++];
+        memset(in, 0, sizeof *in);
+        in->addr = addr;
+        if (mnem[0] == 'j' && operands[0] != '*') {
+            in->target = strtoull(operands, NULL, 16);
+        } else {
+            classify(in, mnem, operands);
+        }
+    }
+    pclose(p);
+    return found;
+}
+
+static long perf_event_open(struct perf_event_attr *attr, pid_t pid) {
+    return syscall(SYS_perf_event_open, attr, pid, -1, -1, 0);
+}
+
+// Runs one pass of loop `run` of `bin` and counts how often each address in
+// `addrs` executes. Returns 0 on success, -1 if the counters are unavailable.
+static int count_executions(const char *bin, size_t run, const uint64_t *addrs, size_t naddrs,
+                            uint64_t *counts) {
+    int fds[MAX_BRANCHES], go[2], status = -1, wstatus;
+    char nbuf[32], rbuf[32];
+    size_t opened = 0;
+    pid_t pid;
+
+    if (pipe(go) != 0) return -1;
+    snprintf(nbuf, sizeof nbuf, "%d", VEC_COUNT_N);
+    snprintf(rbuf, sizeof rbuf, "%zu", run);
+    pid = fork();
+    if (pid < 0) {
+        close(go[0]);
+        close(go[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        char c;
+        close(go[1]);
+        if (read(go[0], &c, 1) != 1) _exit(127);
+        execl(bin, bin, nbuf, rbuf, (char *)NULL);
+        _exit(127);
+    }
+    close(go[0]);
+
+    for (; opened < naddrs; opened++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof attr);
+        attr.size = sizeof attr;
+        attr.type = PERF_TYPE_BREAKPOINT;
+        attr.bp_type = HW_BREAKPOINT_X;
+        attr.bp_addr = addrs[opened];
+        attr.bp_len = sizeof(long);
+        attr.disabled = 1;
+        attr.enable_on_exec = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fds[opened] = (int)perf_event_open(&attr, pid);
+        if (fds[opened] < 0) break;
+    }
+    if (write(go[1], "x", 1) != 1) opened = 0;
+    close(go[1]);
+    if (waitpid(pid, &wstatus, 0) == pid && WIFEXITED(wstatus) && WEXITSTATUS(wstatus) == 0 &&
+        opened == naddrs) {
+        status = 0;
+        for (size_t i = 0; i < naddrs; i++) {
+            if (read(fds[i], &counts[i], sizeof counts[i]) != sizeof counts[i]) status = -1;
+        }
+    }
+    for (size_t i = 0; i < opened; i++) close(fds[i]);
+    return status;
+}
+
+// Returns 0 on success, -1 if the loop has no backward branch or counting
+// failed.
+static int loop_mix(const char *bin, size_t run, const struct FnCode *fn, struct LoopMix *mix) {
+    uint64_t addrs[MAX_BRANCHES], counts[MAX_BRANCHES];
+    size_t branch[MAX_BRANCHES], nb = 0;
+    double insns = 0, loads = 0, shuffles = 0, hottest = 0;
+
+    if (fn->ninsns == 0) return -1;
+    for (size_t i = 0; i < fn->ninsns && nb < MAX_BRANCHES; i++) {
+        const struct Insn *in = &fn->insns[i];
+        if (in->target && in->target <= in->addr && in->target >= fn->insns[0].addr) {
+            branch[nb] = i;
+            addrs[nb++] = in->addr;
+        }
+    }
+    if (nb == 0 || count_executions(bin, run, addrs, nb, counts) != 0) return -1;
+
+    mix->elems_per_iter = 0;
+    for (size_t b = 0; b < nb; b++) {
+        const struct Insn *br = &fn->insns[branch[b]];
+        size_t body = 0, body_loads = 0, body_shuffles = 0;
+        for (size_t i = 0; i <= branch[b]; i++) {
+            const struct Insn *in = &fn->insns[i];
+            if (in->addr < br->target) continue;
+            body++;
+            body_loads += in->load;
+            body_shuffles += in->shuffle;
+        }
+        insns += (double)counts[b] * (double)body;
+        loads += (double)counts[b] * (double)body_loads;
+        shuffles += (double)counts[b] * (double)body_shuffles;
+        if (counts[b] && (double)counts[b] * (double)body > hottest) {
+            hottest = (double)counts[b] * (double)body;
+            mix->elems_per_iter = (double)VEC_COUNT_N / (double)counts[b];
+        }
+    }
+    mix->insns = insns / VEC_COUNT_N;
+    mix->loads = loads / VEC_COUNT_N;
+    mix->shuffles = shuffles / VEC_COUNT_N;
+    return 0;
+}
+
+int vec_report(int argc, char **argv) {
+    size_t n = arg_count(argc, argv, 1, 1000000);
+    const char *dir = argc > 2 ? argv[2] : ".";
+    struct VecLoop loops[VEC_NLAYOUTS * OP_COUNT];
+    struct FnCode *fns = calloc(VEC_NLAYOUTS * OP_COUNT, sizeof *fns);
+    char src[4096], bin[4096], remarks[4096], cmd[16384];
+    int compiled = 0;
+
+    snprintf(src, sizeof src, "%s/vecloops.c", dir);
+    memset(loops, 0, sizeof loops);
+    if (!fns) {
+        fprintf(stderr, "vec-report: out of memory\n");
+        return 1;
+    }
+    if (write_program(src, loops) != 0) {
+        perror("vec-report: cannot write the loop program");
+        free(fns);
+        return 1;
+    }
+
+    for (size_t c = 0; c < sizeof vec_compilers / sizeof vec_compilers[0]; c++) {
+        const struct VecCompiler *cc = &vec_compilers[c];
+        if (!compiler_available(cc->cc)) {
+            printf("%s: not found, skipped\n\n", cc->cc);
+            continue;
+        }
+        for (size_t i = 0; i < VEC_NLAYOUTS * OP_COUNT; i++) {
+            loops[i].how[0] = '\0';
+            loops[i].vectorized = 0;
+            loops[i].ns = -1;
+        }
+        snprintf(bin, sizeof bin, "%s/vecloops-%s", dir, cc->cc);
+        snprintf(remarks, sizeof remarks, "%s/vecloops-%s.txt", dir, cc->cc);
+        // -no-pie keeps the loop addresses objdump prints valid at run time.
+        snprintf(cmd, sizeof cmd, "%s -std=c11 -O3 -march=native -no-pie %s -o '%s' '%s' 2> '%s'",
+                 cc->cc, cc->remarks, bin, src, remarks);
+        if (system(cmd) != 0) {
+            fprintf(stderr, "vec-report: %s failed, see %s\n", cc->cc, remarks);
+            continue;
+        }
+        parse_remarks(remarks, loops, VEC_NLAYOUTS * OP_COUNT);
+        run_program(bin, n, loops, VEC_NLAYOUTS * OP_COUNT);
+        for (size_t k = 0; k < VEC_NLAYOUTS; k++) {
+            for (int op = 0; op < OP_COUNT; op++) {
+                struct FnCode *fn = &fns[k * OP_COUNT + (size_t)op];
+                snprintf(fn->name, sizeof fn->name, "%s_%zu", op_name[op], k);
+                fn->ninsns = 0;
+            }
+        }
+        if (disassemble(bin, fns, VEC_NLAYOUTS * OP_COUNT) < 0) {
+            fprintf(stderr, "vec-report: cannot run objdump\n");
+        }
+
+        printf("%s -O3 -march=native, %zu elements (instruction mix per element):\n", cc->cc, n);
+        printf("%-14s %-7s %-4s %8s %7s %6s %6s %6s  %s\n", "layout", "loop", "vec", "ns/elem",
+               "insns", "loads", "shufs", "el/it", "remark");
+        for (size_t k = 0; k < VEC_NLAYOUTS; k++) {
+            for (int op = 0; op < OP_COUNT; op++) {
+                size_t run = k * OP_COUNT + (size_t)op;
+                const struct VecLoop *lp = &loops[run];
+                struct LoopMix mix;
+                printf("%-14s %-7s %-4s %8.3f ", op == 0 ? vec_layouts[k].name : "", op_name[op],
+                       lp->vectorized ? "yes" : "no", lp->ns);
+                if (loop_mix(bin, run, &fns[run], &mix) == 0) {
+                    printf("%7.2f %6.2f %6.2f %6.1f", mix.insns, mix.loads, mix.shuffles,
+                           mix.elems_per_iter);
+                } else {
+                    printf("%7s %6s %6s %6s", "-", "-", "-", "-");
+                }
+                printf("  %s\n", lp->how[0] ? lp->how : "-");
+            }
+        }
+        printf("\n");
+        unlink(bin);
+        unlink(remarks);
+        compiled++;
+    }
+    unlink(src);
+    free(fns);
+    return compiled ? 0 : 1;
+}
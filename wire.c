@@ -0,0 +1,389 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdalign.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "commands.h"
+#include "human.h"
+#include "layout.h"
+
+// Three wire formats for the same records:
+//   struct  wire_struct_t copied as is: fixed 48-byte stride, names inline in
+//           fixed arrays, padding and unused name bytes included
+//   packed  fields back to back with length-prefixed names, no padding and no
+//           alignment; records can only be found by walking the stream
+//   flat    an offset-table format in the style of FlatBuffers: a vector of
+//           table offsets, one vtable shared by all tables, aligned scalars
+//           inline in each table and names as offsets to length-prefixed
+//           strings. Fields are read in place, without decoding.
+
+#define NAME_CAP 16
+
+typedef struct WireStruct {
+    char    first_initial;
+    int32_t age;
+    double  height;
+    char    first[NAME_CAP];
+    char    last[NAME_CAP];
+} wire_struct_t;
+
+// Flat format. All positions are byte offsets from the start of the buffer:
+//   uint32 count, uint32 vtable_pos, uint32 table_pos[count]
+//   vtable: uint16 vtable_bytes, uint16 table_bytes, uint16 field_off[FLAT_NFIELDS]
+//   per record, 8-aligned: table, then its strings (uint32 len, bytes, NUL)
+// A table starts with an int32 distance back to its vtable; a field offset of
+// 0 in the vtable means the field is absent and reads as its default.
+enum FlatField { FLAT_AGE, FLAT_HEIGHT, FLAT_FIRST, FLAT_LAST, FLAT_INITIAL, FLAT_NFIELDS };
+
+typedef struct FlatTable {
+    int32_t  vtable;
+    int32_t  age;
+    double   height;
+    uint32_t first;   // relative to the field itself
+    uint32_t last;
+    char     first_initial;
+} flat_table_t;
+
+static const uint16_t flat_vtable[2 + FLAT_NFIELDS] = {
+    sizeof flat_vtable,
+    offsetof(flat_table_t, first_initial) + 1,
+    offsetof(flat_table_t, age),
+    offsetof(flat_table_t, height),
+    offsetof(flat_table_t, first),
+    offsetof(flat_table_t, last),
+    offsetof(flat_table_t, first_initial),
+};
+
+static inline size_t align_up(size_t x, size_t a) {
+    return (x + a - 1) & ~(a - 1);
+}
+
+static inline uint32_t read_u32(const unsigned char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof v);
+    return v;
+}
+
+static inline void write_u32(unsigned char *p, uint32_t v) {
+    memcpy(p, &v, sizeof v);
+}
+
+static void fill_struct(wire_struct_t *w, const human1_t *h) {
+    memset(w, 0, sizeof *w);
+    w->first_initial = h->first_initial;
+    w->age = h->age;
+    w->height = h->height;
+    memcpy(w->first, h->name.first, strnlen(h->name.first, NAME_CAP - 1));
+    memcpy(w->last, h->name.last, strnlen(h->name.last, NAME_CAP - 1));
+}
+
+static size_t encode_struct(unsigned char *out, const human1_t *rows, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        wire_struct_t w;
+        fill_struct(&w, &rows[i]);
+        memcpy(out + i * sizeof w, &w, sizeof w);
+    }
+    return n * sizeof(wire_struct_t);
+}
+
+static void decode_struct(wire_struct_t *out, const unsigned char *buf, size_t n) {
+    memcpy(out, buf, n * sizeof *out);
+}
+
+static inline const wire_struct_t *struct_at(const unsigned char *buf, size_t i) {
+    return (const wire_struct_t *)buf + i;
+}
+
+// Packed: height 8, age 4, initial 1, first_len 1, first, last_len 1, last.
+static size_t encode_packed(unsigned char *out, uint32_t *index, const human1_t *rows, size_t n) {
+    unsigned char *p = out;
+    for (size_t i = 0; i < n; i++) {
+        size_t lf = strnlen(rows[i].name.first, NAME_CAP - 1);
+        size_t ll = strnlen(rows[i].name.last, NAME_CAP - 1);
+        int32_t age = rows[i].age;
+        index[i] = (uint32_t)(p - out);
+        memcpy(p, &rows[i].height, 8);
+        memcpy(p + 8, &age, 4);
+        p[12] = (unsigned char)rows[i].first_initial;
+        p[13] = (unsigned char)lf;
+        memcpy(p + 14, rows[i].name.first, lf);
+        p += 14 + lf;
+        *p++ = (unsigned char)ll;
+        memcpy(p, rows[i].name.last, ll);
+        p += ll;
+    }
+    return (size_t)(p - out);
+}
+
+static void decode_packed(wire_struct_t *out, const unsigned char *buf, size_t n) {
+    const unsigned char *p = buf;
+    for (size_t i = 0; i < n; i++) {
+        wire_struct_t *w = &out[i];
+        size_t len;
+        memset(w, 0, sizeof *w);
+        memcpy(&w->height, p, 8);
+        memcpy(&w->age, p + 8, 4);
+        w->first_initial = (char)p[12];
+        len = p[13];
+        memcpy(w->first, p + 14, len);
+        p += 14 + len;
+        len = *p++;
+        memcpy(w->last, p, len);
+        p += len;
+    }
+}
+
+static size_t flat_bound(size_t n) {
+    return align_up(8 + 4 * n + sizeof flat_vtable, 8) +
+           n * align_up(sizeof(flat_table_t) + 2 * align_up(4 + NAME_CAP, 4), 8);
+}
+
+static size_t flat_string(unsigned char *buf, size_t pos, const char *s) {
+    uint32_t len = (uint32_t)strnlen(s, NAME_CAP - 1);
+    write_u32(buf + pos, len);
+    memcpy(buf + pos + 4, s, len);
+    buf[pos + 4 + len] = '\0';
+    return align_up(pos + 4 + len + 1, 4);
+}
+
+static size_t encode_flat(unsigned char *out, const human1_t *rows, size_t n) {
+    size_t vpos = 8 + 4 * n;
+    size_t pos = align_up(vpos + sizeof flat_vtable, 8);
+
+    write_u32(out, (uint32_t)n);
+    write_u32(out + 4, (uint32_t)vpos);
+    memcpy(out + vpos, flat_vtable, sizeof flat_vtable);
+    for (size_t i = 0; i < n; i++) {
+        flat_table_t t;
+        size_t tpos = align_up(pos, 8), spos;
+        memset(&t, 0, sizeof t);
+        t.vtable = (int32_t)(tpos - vpos);
+        t.age = rows[i].age;
+        t.height = rows[i].height;
+        t.first_initial = rows[i].first_initial;
+        // Strings start in the table's tail padding, which is never written.
+        spos = align_up(tpos + flat_vtable[1], 4);
+        t.first = (uint32_t)(spos - (tpos + offsetof(flat_table_t, first)));
+        spos = flat_string(out, spos, rows[i].name.first);
+        t.last = (uint32_t)(spos - (tpos + offsetof(flat_table_t, last)));
+        spos = flat_string(out, spos, rows[i].name.last);
+        memcpy(out + tpos, &t, flat_vtable[1]);
+        write_u32(out + 8 + 4 * i, (uint32_t)tpos);
+        pos = spos;
+    }
+    return pos;
+}
+
+// Accessors read through the vtable exactly as generated FlatBuffers code
+// does, so an older or newer writer with a different vtable still works.
+static inline const unsigned char *flat_table(const unsigned char *buf, size_t i) {
+    return buf + read_u32(buf + 8 + 4 * i);
+}
+
+static inline uint16_t flat_field(const unsigned char *table, enum FlatField f) {
+    int32_t back;
+    uint16_t off, vbytes;
+    const unsigned char *vt;
+    memcpy(&back, table, sizeof back);
+    vt = table - back;
+    memcpy(&vbytes, vt, sizeof vbytes);
+    if (4u + 2u * (unsigned)f >= vbytes) return 0;
+    memcpy(&off, vt + 4 + 2 * f, sizeof off);
+    return off;
+}
+
+static inline int32_t flat_age(const unsigned char *table) {
+    uint16_t off = flat_field(table, FLAT_AGE);
+    int32_t v = 0;
+    if (off) memcpy(&v, table + off, sizeof v);
+    return v;
+}
+
+static inline const char *flat_str(const unsigned char *table, enum FlatField f, uint32_t *len) {
+    uint16_t off = flat_field(table, f);
+    const unsigned char *s;
+    if (!off) {
+        *len = 0;
+        return "";
+    }
+    s = table + off + read_u32(table + off);
+    *len = read_u32(s);
+    return (const char *)s + 4;
+}
+
+static void decode_flat(wire_struct_t *out, const unsigned char *buf, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        const unsigned char *t = flat_table(buf, i);
+        wire_struct_t *w = &out[i];
+        uint16_t off;
+        uint32_t len;
+        const char *s;
+        memset(w, 0, sizeof *w);
+        w->age = flat_age(t);
+        if ((off = flat_field(t, FLAT_HEIGHT))) memcpy(&w->height, t + off, sizeof w->height);
+        if ((off = flat_field(t, FLAT_INITIAL))) w->first_initial = (char)t[off];
+        s = flat_str(t, FLAT_FIRST, &len);
+        memcpy(w->first, s, len);
+        s = flat_str(t, FLAT_LAST, &len);
+        memcpy(w->last, s, len);
+    }
+}
+
+static inline uint64_t hash_bytes(const char *s, size_t len) {
+    uint64_t h = 1469598103934665603u;
+    for (size_t i = 0; i < len; i++) h = (h ^ (unsigned char)s[i]) * 1099511628211u;
+    return h;
+}
+
+// Random access: age plus a hash of the last name of each picked record.
+static uint64_t access_struct(const unsigned char *buf, const uint32_t *idx, size_t n) {
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) {
+        const wire_struct_t *w = struct_at(buf, idx[i]);
+        acc += (uint64_t)w->age + hash_bytes(w->last, strnlen(w->last, NAME_CAP));
+    }
+    return acc;
+}
+
+static uint64_t access_packed(const unsigned char *buf, const uint32_t *index, const uint32_t *idx,
+                              size_t n) {
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) {
+        const unsigned char *p = buf + index[idx[i]];
+        int32_t age;
+        memcpy(&age, p + 8, sizeof age);
+        p += 14 + p[13];
+        acc += (uint64_t)age + hash_bytes((const char *)p + 1, *p);
+    }
+    return acc;
+}
+
+static uint64_t access_flat(const unsigned char *buf, const uint32_t *idx, size_t n) {
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; i++) {
+        const unsigned char *t = flat_table(buf, idx[i]);
+        uint32_t len;
+        const char *s = flat_str(t, FLAT_LAST, &len);
+        acc += (uint64_t)flat_age(t) + hash_bytes(s, len);
+    }
+    return acc;
+}
+
+static void report(const char *name, size_t n, size_t bytes, uint64_t enc, uint64_t dec,
+                   uint64_t acc, int ok) {
+    printf("%-8s %10.1f %10.1f %10.1f %10.1f %10.1f%s\n", name, (double)bytes / (double)n,
+           (double)enc / (double)n, (double)dec / (double)n, (double)acc / (double)n,
+           (double)bytes / ((double)enc / 1e9) / 1e6, ok ? "" : "  MISMATCH");
+}
+
+int bench_wire(int argc, char **argv) {
+    size_t n = arg_count(argc, argv, 1, 1000000);
+    human1_t *rows = malloc(n * sizeof *rows);
+    wire_struct_t *expect = malloc(n * sizeof *expect);
+    wire_struct_t *decoded = malloc(n * sizeof *decoded);
+    unsigned char *sbuf = malloc(n * sizeof(wire_struct_t));
+    unsigned char *pbuf = malloc(n * (15 + 2 * NAME_CAP));
+    unsigned char *fbuf = malloc(flat_bound(n));
+    uint32_t *index = malloc(n * sizeof *index);
+    uint32_t *idx = malloc(n * sizeof *idx);
+    struct FieldDesc struct_fields[] = {
+        FIELD(wire_struct_t,       first_initial, 'I'),
+        FIELD(wire_struct_t,       age,           'A'),
+        FIELD(wire_struct_t,       height,        'H'),
+        ARRAY_FIELD(wire_struct_t, first,         'F'),
+        ARRAY_FIELD(wire_struct_t, last,          'L'),
+    };
+    struct FieldDesc table_fields[] = {
+        FIELD(flat_table_t, vtable,        'V'),
+        FIELD(flat_table_t, age,           'A'),
+        FIELD(flat_table_t, height,        'H'),
+        FIELD(flat_table_t, first,         'F'),
+        FIELD(flat_table_t, last,          'L'),
+        FIELD(flat_table_t, first_initial, 'I'),
+    };
+    uint64_t state = 0x9e3779b97f4a7c15u, want, got, t0, enc, dec, acc;
+    size_t bytes;
+    int status = 1, ok;
+
+    if (!rows || !expect || !decoded || !sbuf || !pbuf || !fbuf || !index || !idx) {
+        fprintf(stderr, "bench-wire: cannot allocate %zu records\n", n);
+        goto out;
+    }
+    human_fill(rows, n, 23);
+    for (size_t i = 0; i < n; i++) {
+        fill_struct(&expect[i], &rows[i]);
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        idx[i] = (uint32_t)(state % n);
+    }
+
+    visualize("WireStruct", sizeof(wire_struct_t), struct_fields, NFIELDS(struct_fields));
+    padding_report("WireStruct", sizeof(wire_struct_t), alignof(wire_struct_t), struct_fields,
+                   NFIELDS(struct_fields));
+    visualize("FlatTable", sizeof(flat_table_t), table_fields, NFIELDS(table_fields));
+    printf("(a FlatTable occupies %zu bytes on the wire; its strings start in the tail padding)\n",
+           (size_t)flat_vtable[1]);
+
+    printf("\n%zu records; sizes in bytes/record, times in ns/record:\n", n);
+    printf("%-8s %10s %10s %10s %10s %10s\n", "format", "size", "encode", "decode", "access",
+           "enc MB/s");
+    want = access_struct((const unsigned char *)expect, idx, n);
+
+    t0 = now_ns();
+    bytes = encode_struct(sbuf, rows, n);
+    enc = now_ns() - t0;
+    t0 = now_ns();
+    decode_struct(decoded, sbuf, n);
+    dec = now_ns() - t0;
+    ok = memcmp(decoded, expect, n * sizeof *expect) == 0;
+    t0 = now_ns();
+    got = access_struct(sbuf, idx, n);
+    acc = now_ns() - t0;
+    report("struct", n, bytes, enc, dec, acc, ok && got == want);
+    bench_sink += got;
+
+    t0 = now_ns();
+    bytes = encode_packed(pbuf, index, rows, n);
+    enc = now_ns() - t0;
+    t0 = now_ns();
+    decode_packed(decoded, pbuf, n);
+    dec = now_ns() - t0;
+    ok = memcmp(decoded, expect, n * sizeof *expect) == 0;
+    t0 = now_ns();
+    got = access_packed(pbuf, index, idx, n);
+    acc = now_ns() - t0;
+    report("packed", n, bytes, enc, dec, acc, ok && got == want);
+    bench_sink += got;
+
+    t0 = now_ns();
+    bytes = encode_flat(fbuf, rows, n);
+    enc = now_ns() - t0;
+    t0 = now_ns();
+    decode_flat(decoded, fbuf, n);
+    dec = now_ns() - t0;
+    ok = memcmp(decoded, expect, n * sizeof *expect) == 0;
+    t0 = now_ns();
+    got = access_flat(fbuf, idx, n);
+    acc = now_ns() - t0;
+    report("flat", n, bytes, enc, dec, acc, ok && got == want);
+    bench_sink += got;
+
+    printf("packed has no random access of its own; its access column uses a separate\n"
+           "%zu-byte/record offset index that is not counted in its size.\n", sizeof *index);
+    status = 0;
+
+out:
+    free(rows);
+    free(expect);
+    free(decoded);
+    free(sbuf);
+    free(pbuf);
+    free(fbuf);
+    free(index);
+    free(idx);
+    return status;
+}